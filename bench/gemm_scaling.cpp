@@ -0,0 +1,106 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** Measure how the matrix-matrix product scales with the thread count
+ *
+ *     gemm_scaling [size [max threads [repetitions]]]
+ *
+ * Square products of the given size are timed for every thread count
+ * from one up to the maximum, which defaults to the hardware
+ * concurrency.
+ */
+
+#include "vecmat/gemm.hpp"
+#include "vecmat/thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+template <typename T>
+double seconds(size_t n, size_t reps)
+{
+    std::vector<T> a(n * n), b(n * n), c(n * n);
+    for (size_t i = 0; i < n * n; ++i)
+    {
+        a[i] = static_cast<T>(i % 17) / static_cast<T>(17);
+        b[i] = static_cast<T>(i % 13) / static_cast<T>(13);
+    }
+
+    // Warm up the pool and the caches
+    vecmat::gemm(n, n, n, a.data(), n, b.data(), n, c.data(), n);
+
+    double best = 1e300;
+    for (size_t r = 0; r < reps; ++r)
+    {
+        auto start = std::chrono::steady_clock::now();
+        vecmat::gemm(n, n, n, a.data(), n, b.data(), n, c.data(), n);
+        std::chrono::duration<double> dt =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, dt.count());
+    }
+    return best;
+}
+
+template <typename T>
+void scale(const char * name, size_t n, size_t threads, size_t reps)
+{
+    std::cout << name << " " << n << "x" << n << std::endl;
+    std::cout << "threads     GFLOP/s  speedup  efficiency" << std::endl;
+    double base = 0;
+    for (size_t t = 1; t <= threads; ++t)
+    {
+        vecmat::set_num_threads(t);
+        double s = seconds<T>(n, reps);
+        if (t == 1)
+            base = s;
+        double gflops = 2.0 * n * n * n / s * 1e-9;
+        std::cout << std::setw(7) << t
+            << std::setw(12) << std::fixed << std::setprecision(2) << gflops
+            << std::setw(9) << base / s
+            << std::setw(12) << base / s / t << std::endl;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+                              : std::thread::hardware_concurrency();
+    size_t reps = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5;
+    threads = std::max<size_t>(threads, 1);
+
+    scale<float>("float", n, threads, reps);
+    scale<double>("double", n, threads, reps);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** Measure what the reproducible mode costs over the fast inner product
+ *
+ *     reproducible_dot [length [max threads [repetitions]]]
+ *
+ * The fast `dot` runs on the calling thread; the reproducible one is
+ * timed for every thread count from one up to the maximum, which
+ * defaults to the hardware concurrency.  The last column checks the
+ * bits did not change.
+ */
+
+#include "vecmat/accumulate.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+template <typename T, typename Mode>
+double seconds(const vecmat::dvector<T> & a, const vecmat::dvector<T> & b,
+               Mode mode, size_t reps, T & result)
+{
+    // Warm up the pool and the caches
+    result = vecmat::dot(a, b, mode);
+
+    double best = 1e300;
+    for (size_t r = 0; r < reps; ++r)
+    {
+        auto start = std::chrono::steady_clock::now();
+        result = vecmat::dot(a, b, mode);
+        std::chrono::duration<double> dt =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, dt.count());
+    }
+    return best;
+}
+
+template <typename T>
+void compare(const char * name, size_t n, size_t threads, size_t reps)
+{
+    vecmat::dvector<T> a(n), b(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = static_cast<T>(1) / static_cast<T>(i % 977 + 3);
+        b[i] = static_cast<T>(i % 13) / static_cast<T>(7) - 1;
+    }
+
+    vecmat::set_num_threads(1);
+    T fast = 0;
+    const double base = seconds(a, b, vecmat::fast_sum(), reps, fast);
+    std::cout << name << " " << n << ", fast dot "
+              << std::fixed << std::setprecision(2)
+              << 2.0 * n / base * 1e-9 << " GFLOP/s" << std::endl;
+    std::cout << "threads     GFLOP/s  vs fast  same bits" << std::endl;
+    T first = 0;
+    for (size_t t = 1; t <= threads; ++t)
+    {
+        vecmat::set_num_threads(t);
+        T r = 0;
+        double s = seconds(a, b, vecmat::reproducible_sum(), reps, r);
+        if (t == 1)
+            first = r;
+        std::cout << std::setw(7) << t
+            << std::setw(12) << 2.0 * n / s * 1e-9
+            << std::setw(9) << base / s
+            << std::setw(11) << (r == first ? "yes" : "no") << std::endl;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 24;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+                              : std::thread::hardware_concurrency();
+    size_t reps = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 10;
+    threads = std::max<size_t>(threads, 1);
+
+    compare<float>("float", n, threads, reps);
+    compare<double>("double", n, threads, reps);
+    return EXIT_SUCCESS;
+}
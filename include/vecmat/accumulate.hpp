@@ -0,0 +1,582 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_ACCUMULATE_H
+#define VECMAT_ACCUMULATE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/reduce.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/thread_pool.hpp"
+#include "vecmat/vector.hpp"
+
+namespace vecmat {
+
+/** # Accumulation modes
+ *
+ * `dot`, `sum`, and `norm` take an optional mode as their last
+ * argument that trades a little speed for accuracy:
+ *
+ * * `fast_sum` is what they do without one: several accumulators, a
+ *   register wide each, with an error that grows with the length.
+ * * `pairwise_sum` splits the input in halves until the pieces are a
+ *   block long and adds the pieces as a tree, so the error only grows
+ *   with the logarithm of the length.  It runs the fast kernels.
+ * * `compensated_sum` carries the rounding error of every addition
+ *   (and, with a fused multiply-add, of every product) along with the
+ *   sum in each lane, which gives a result as accurate as twice the
+ *   working precision.  The error terms use Knuth's branch free two
+ *   sum, so do not build it with `-ffast-math`.
+ * * `widened_sum` accumulates in `wider<T>::type`: `float` in
+ *   `double` (converted in registers as it loads) and `double` in
+ *   `long double` (converted a block at a time).
+ * * `reproducible_sum` gives the same bits whatever the thread count
+ *   or instruction set.  The input is cut into chunks of a fixed
+ *   length, each chunk is added in sixteen interleaved lanes whatever
+ *   the register width, and the lanes and then the chunks are added
+ *   as fixed trees.  Large inputs spread the chunks across the thread
+ *   pool.  Products are rounded before they are added, so the result
+ *   only holds across builds that do not contract multiplies and adds
+ *   (`-ffp-contract=off`, the default for ISO C++ in GCC).
+ *
+ * The result is always rounded back to the element type, but the
+ * widened norm takes its square root before rounding.  An infinite
+ * compensated sum is returned as is, without its error term.
+ */
+struct fast_sum {};
+struct pairwise_sum {};
+struct compensated_sum {};
+struct widened_sum {};
+struct reproducible_sum {};
+
+template <typename Mode>
+struct is_accumulation : std::false_type {};
+template <> struct is_accumulation<fast_sum> : std::true_type {};
+template <> struct is_accumulation<pairwise_sum> : std::true_type {};
+template <> struct is_accumulation<compensated_sum> : std::true_type {};
+template <> struct is_accumulation<widened_sum> : std::true_type {};
+template <> struct is_accumulation<reproducible_sum> : std::true_type {};
+
+/** The accumulator type of `widened_sum`
+ */
+template <typename T> struct wider { typedef T type; };
+template <> struct wider<float> { typedef double type; };
+template <> struct wider<double> { typedef long double type; };
+template <> struct wider<int32_t> { typedef int64_t type; };
+
+namespace detail {
+
+/** The length of the leaves of the pairwise tree */
+static const size_t pairwise_block = 256;
+
+/** The length of the blocks converted by the widened mode */
+static const size_t widened_block = 64;
+
+/** The lanes and the chunk length of the reproducible mode.  Both are
+ * part of the result, so changing them changes the bits.
+ */
+static const size_t reproducible_lanes = 16;
+static const size_t reproducible_chunk = 4096;
+
+/** The length past which the reproducible chunks run in parallel */
+static const size_t reproducible_parallel_threshold = 1 << 16;
+
+/** ## Fast
+ */
+template <typename T>
+T accumulate(const T * a, size_t n, fast_sum)
+{
+    return simd::fold<simd::plus>(a, n, static_cast<T>(0));
+}
+template <typename T>
+T accumulate(const T * a, const T * b, size_t n, fast_sum)
+{
+    return simd::inner(a, b, n);
+}
+
+/** ## Pairwise
+ *
+ * The split is rounded to a whole block so every leaf but the last is
+ * a full block.
+ */
+inline size_t pairwise_split(size_t n)
+{
+    return (n / 2 + pairwise_block - 1) / pairwise_block * pairwise_block;
+}
+
+template <typename T>
+T accumulate(const T * a, size_t n, pairwise_sum)
+{
+    if (n <= pairwise_block)
+        return accumulate(a, n, fast_sum());
+    const size_t h = pairwise_split(n);
+    return accumulate(a, h, pairwise_sum()) +
+           accumulate(a + h, n - h, pairwise_sum());
+}
+template <typename T>
+T accumulate(const T * a, const T * b, size_t n, pairwise_sum)
+{
+    if (n <= pairwise_block)
+        return accumulate(a, b, n, fast_sum());
+    const size_t h = pairwise_split(n);
+    return accumulate(a, b, h, pairwise_sum()) +
+           accumulate(a + h, b + h, n - h, pairwise_sum());
+}
+
+/** ## Compensated
+ *
+ * Add `x` to `s` and the rounding error of the addition to `c`.
+ */
+template <typename P>
+void two_sum(typename P::type & s, typename P::type & c,
+             typename P::type x)
+{
+    const typename P::type t = P::add(s, x);
+    const typename P::type z = P::sub(t, s);
+    c = P::add(c, P::add(P::sub(s, P::sub(t, z)), P::sub(x, z)));
+    s = t;
+}
+
+/** The compensated sum `s + c`, or `s` alone when it is not finite.
+ * An infinite sum makes the error term `inf - inf`, so, as in
+ * Neumaier's method, the error is dropped rather than turning the
+ * result into NaN.
+ */
+template <typename T>
+T compensated_result(T s, T c)
+{
+    return std::isfinite(s) ? s + c : s;
+}
+
+/** Add the lanes of two pairs of sums and errors to `s` and `c`
+ */
+template <typename P>
+void two_sum_lanes(typename P::value_type & s, typename P::value_type & c,
+                   typename P::type s0, typename P::type c0,
+                   typename P::type s1, typename P::type c1)
+{
+    typedef typename P::value_type T;
+    typedef simd::scalar<T> S;
+    T ls0[P::width], lc0[P::width], ls1[P::width], lc1[P::width];
+    P::storeu(ls0, s0);
+    P::storeu(lc0, c0);
+    P::storeu(ls1, s1);
+    P::storeu(lc1, c1);
+    for (size_t k = 0; k < P::width; ++k)
+    {
+        two_sum<S>(s, c, ls0[k]);
+        two_sum<S>(s, c, ls1[k]);
+        c += lc0[k] + lc1[k];
+    }
+}
+
+template <typename T>
+T accumulate(const T * a, size_t n, compensated_sum)
+{
+    typedef simd::pack<T> P;
+    typedef simd::scalar<T> S;
+
+    const typename P::type zero = P::set1(static_cast<T>(0));
+    typename P::type s0 = zero, c0 = zero, s1 = zero, c1 = zero;
+    const size_t m = n - n % (2 * P::width);
+    size_t i = 0;
+    for (; i < m; i += 2 * P::width)
+    {
+        two_sum<P>(s0, c0, P::loadu(a + i));
+        two_sum<P>(s1, c1, P::loadu(a + i + P::width));
+    }
+    T s = 0, c = 0;
+    two_sum_lanes<P>(s, c, s0, c0, s1, c1);
+    for (; i < n; ++i)
+        two_sum<S>(s, c, a[i]);
+    return compensated_result(s, c);
+}
+
+/** The error of each product is exact when the multiply-add is fused
+ * and zero otherwise.
+ */
+template <typename T>
+T accumulate(const T * a, const T * b, size_t n, compensated_sum)
+{
+    typedef simd::pack<T> P;
+    typedef simd::scalar<T> S;
+
+    const typename P::type zero = P::set1(static_cast<T>(0));
+    typename P::type s0 = zero, c0 = zero, s1 = zero, c1 = zero;
+    const size_t m = n - n % (2 * P::width);
+    size_t i = 0;
+    for (; i < m; i += 2 * P::width)
+    {
+        const typename P::type x0 = P::loadu(a + i);
+        const typename P::type y0 = P::loadu(b + i);
+        const typename P::type x1 = P::loadu(a + i + P::width);
+        const typename P::type y1 = P::loadu(b + i + P::width);
+        const typename P::type p0 = P::mul(x0, y0);
+        const typename P::type p1 = P::mul(x1, y1);
+        c0 = P::add(c0, P::fmadd(x0, y0, P::sub(zero, p0)));
+        c1 = P::add(c1, P::fmadd(x1, y1, P::sub(zero, p1)));
+        two_sum<P>(s0, c0, p0);
+        two_sum<P>(s1, c1, p1);
+    }
+    T s = 0, c = 0;
+    two_sum_lanes<P>(s, c, s0, c0, s1, c1);
+    for (; i < n; ++i)
+    {
+        const T p = a[i] * b[i];
+        c += simd::fused(a[i], b[i], -p);
+        two_sum<S>(s, c, p);
+    }
+    return compensated_result(s, c);
+}
+
+/** ## Widened
+ *
+ * Whole blocks are converted with a fixed trip count, which the
+ * compiler turns into vector conversions.
+ */
+template <typename T>
+T accumulate(const T * a, size_t n, widened_sum)
+{
+    typedef typename wider<T>::type W;
+    const size_t B = widened_block;
+
+    W x[B];
+    W s = 0;
+    size_t i = 0;
+    for (; i + B <= n; i += B)
+    {
+        for (size_t k = 0; k < B; ++k)
+            x[k] = a[i + k];
+        s += accumulate(x, B, fast_sum());
+    }
+    for (; i < n; ++i)
+        s += a[i];
+    return static_cast<T>(s);
+}
+template <typename T>
+typename wider<T>::type widened_inner(const T * a, const T * b, size_t n)
+{
+    typedef typename wider<T>::type W;
+    const size_t B = widened_block;
+
+    W x[B], y[B];
+    W s = 0;
+    size_t i = 0;
+    for (; i + B <= n; i += B)
+    {
+        for (size_t k = 0; k < B; ++k)
+        {
+            x[k] = a[i + k];
+            y[k] = b[i + k];
+        }
+        s += accumulate(x, y, B, fast_sum());
+    }
+    for (; i < n; ++i)
+        s += static_cast<W>(a[i]) * static_cast<W>(b[i]);
+    return s;
+}
+
+/** `float` widens in registers as it loads, which skips the buffer.
+ */
+template <typename P>
+typename P::value_type sum_lanes(typename P::type a)
+{
+    typename P::value_type lanes[P::width];
+    P::storeu(lanes, a);
+    typename P::value_type s = 0;
+    for (size_t k = 0; k < P::width; ++k)
+        s += lanes[k];
+    return s;
+}
+
+inline float accumulate(const float * a, size_t n, widened_sum)
+{
+    typedef simd::pack<double> P;
+    const size_t W = P::width;
+
+    const P::type zero = P::set1(0.0);
+    P::type s0 = zero, s1 = zero, s2 = zero, s3 = zero;
+    const size_t m = n - n % (4 * W);
+    size_t i = 0;
+    for (; i < m; i += 4 * W)
+    {
+        s0 = P::add(s0, P::widen(a + i));
+        s1 = P::add(s1, P::widen(a + i + W));
+        s2 = P::add(s2, P::widen(a + i + 2 * W));
+        s3 = P::add(s3, P::widen(a + i + 3 * W));
+    }
+    double s = sum_lanes<P>(P::add(P::add(s0, s1), P::add(s2, s3)));
+    for (; i < n; ++i)
+        s += a[i];
+    return static_cast<float>(s);
+}
+inline double widened_inner(const float * a, const float * b, size_t n)
+{
+    typedef simd::pack<double> P;
+    const size_t W = P::width;
+
+    const P::type zero = P::set1(0.0);
+    P::type s0 = zero, s1 = zero, s2 = zero, s3 = zero;
+    const size_t m = n - n % (4 * W);
+    size_t i = 0;
+    for (; i < m; i += 4 * W)
+    {
+        s0 = P::fmadd(P::widen(a + i), P::widen(b + i), s0);
+        s1 = P::fmadd(P::widen(a + i + W), P::widen(b + i + W), s1);
+        s2 = P::fmadd(P::widen(a + i + 2 * W), P::widen(b + i + 2 * W),
+                      s2);
+        s3 = P::fmadd(P::widen(a + i + 3 * W), P::widen(b + i + 3 * W),
+                      s3);
+    }
+    double s = sum_lanes<P>(P::add(P::add(s0, s1), P::add(s2, s3)));
+    for (; i < n; ++i)
+        s += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+    return s;
+}
+
+/** The inner product is kept wide until the end so a norm can take
+ * its square root before rounding.
+ */
+template <typename T>
+T accumulate(const T * a, const T * b, size_t n, widened_sum)
+{
+    return static_cast<T>(widened_inner(a, b, n));
+}
+
+/** ## Reproducible
+ *
+ * Element `i` of a chunk always lands in lane `i % 16`.  A register
+ * holds `P::width` neighbouring lanes, so the packs only change how
+ * many registers carry the sixteen lanes and not what is added where.
+ */
+template <typename T>
+T reproducible_tree(T * x, size_t n)
+{
+    for (; n > 1; n = (n + 1) / 2)
+    {
+        for (size_t k = 0; k < n / 2; ++k)
+            x[k] = x[2 * k] + x[2 * k + 1];
+        if (n % 2)
+            x[n / 2] = x[n - 1];
+    }
+    return n ? x[0] : T(0);
+}
+
+template <typename P, typename T>
+T reproducible_block(const T * a, size_t n)
+{
+    const size_t L = reproducible_lanes;
+    const size_t R = L / P::width;
+    static_assert(L % P::width == 0, "the lanes fill whole registers");
+
+    typename P::type s[R];
+    for (size_t r = 0; r < R; ++r)
+        s[r] = P::set1(T(0));
+    const size_t m = n - n % L;
+    size_t i = 0;
+    for (; i < m; i += L)
+        for (size_t r = 0; r < R; ++r)
+            s[r] = P::add(s[r], P::loadu(a + i + r * P::width));
+    T lanes[L];
+    for (size_t r = 0; r < R; ++r)
+        P::storeu(lanes + r * P::width, s[r]);
+    for (; i < n; ++i)
+        lanes[i % L] += a[i];
+    return reproducible_tree(lanes, L);
+}
+
+template <typename P, typename T>
+T reproducible_block(const T * a, const T * b, size_t n)
+{
+    const size_t L = reproducible_lanes;
+    const size_t R = L / P::width;
+    static_assert(L % P::width == 0, "the lanes fill whole registers");
+
+    typename P::type s[R];
+    for (size_t r = 0; r < R; ++r)
+        s[r] = P::set1(T(0));
+    const size_t m = n - n % L;
+    size_t i = 0;
+    for (; i < m; i += L)
+        for (size_t r = 0; r < R; ++r)
+        {
+            const size_t j = i + r * P::width;
+            s[r] = P::add(s[r], P::mul(P::loadu(a + j), P::loadu(b + j)));
+        }
+    T lanes[L];
+    for (size_t r = 0; r < R; ++r)
+        P::storeu(lanes + r * P::width, s[r]);
+    for (; i < n; ++i)
+    {
+        const T p = a[i] * b[i];
+        lanes[i % L] += p;
+    }
+    return reproducible_tree(lanes, L);
+}
+
+/** Add the chunks of `[0, n)` with `f(i0, i1)` and then as a tree
+ */
+template <typename T, typename F>
+T reproducible_chunks(size_t n, F f)
+{
+    const size_t C = reproducible_chunk;
+    if (n <= C)
+        return f(0, n);
+    std::vector<T> partial((n + C - 1) / C);
+    if (n < reproducible_parallel_threshold || num_threads() < 2)
+        for (size_t t = 0; t < partial.size(); ++t)
+            partial[t] = f(t * C, std::min(n, (t + 1) * C));
+    else
+        parallel_for(partial.size(), [&](size_t t) {
+            partial[t] = f(t * C, std::min(n, (t + 1) * C));
+        });
+    return reproducible_tree(partial.data(), partial.size());
+}
+
+template <typename T>
+T accumulate(const T * a, size_t n, reproducible_sum)
+{
+    return reproducible_chunks<T>(n, [=](size_t i0, size_t i1) {
+        return reproducible_block<simd::pack<T> >(a + i0, i1 - i0);
+    });
+}
+template <typename T>
+T accumulate(const T * a, const T * b, size_t n, reproducible_sum)
+{
+    return reproducible_chunks<T>(n, [=](size_t i0, size_t i1) {
+        return reproducible_block<simd::pack<T> >(a + i0, b + i0, i1 - i0);
+    });
+}
+
+template <typename T, typename Mode>
+T accumulate_norm(const T * a, size_t n, Mode mode)
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "norms need floating point values");
+    return std::sqrt(accumulate(a, a, n, mode));
+}
+
+/** The widened norm takes the square root of the wide sum of squares,
+ * so a norm that fits in `T` is returned even when its square does
+ * not.
+ */
+template <typename T>
+T accumulate_norm(const T * a, size_t n, widened_sum)
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "norms need floating point values");
+    return static_cast<T>(std::sqrt(widened_inner(a, a, n)));
+}
+
+}; // end namespace detail
+
+/** ## Inner products
+ */
+template <size_t N, typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+dot(const vector<N, T> & a, const vector<N, T> & b, Mode mode)
+{
+    return detail::accumulate(a.data, b.data, N, mode);
+}
+template <typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+dot(const dvector<T> & a, const dvector<T> & b, Mode mode)
+{
+    if (a.size() != b.size())
+        throw std::out_of_range(__func__);
+    return detail::accumulate(a.data(), b.data(), a.size(), mode);
+}
+
+/** ## Sums
+ */
+template <size_t N, typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+sum(const vector<N, T> & a, Mode mode)
+{
+    return detail::accumulate(a.data, N, mode);
+}
+template <size_t N, size_t M, typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+sum(const matrix<N, M, T> & a, Mode mode)
+{
+    return detail::accumulate(a.data, N * M, mode);
+}
+template <typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+sum(const dvector<T> & a, Mode mode)
+{
+    return detail::accumulate(a.data(), a.size(), mode);
+}
+template <typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+sum(const dmatrix<T> & a, Mode mode)
+{
+    return detail::accumulate(a.data(), a.size(), mode);
+}
+
+/** ## Norms
+ */
+template <size_t N, typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+norm(const vector<N, T> & a, Mode mode)
+{
+    return detail::accumulate_norm(a.data, N, mode);
+}
+template <size_t N, size_t M, typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+norm(const matrix<N, M, T> & a, Mode mode)
+{
+    return detail::accumulate_norm(a.data, N * M, mode);
+}
+template <typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+norm(const dvector<T> & a, Mode mode)
+{
+    return detail::accumulate_norm(a.data(), a.size(), mode);
+}
+template <typename T, typename Mode>
+typename std::enable_if<is_accumulation<Mode>::value, T>::type
+norm(const dmatrix<T> & a, Mode mode)
+{
+    return detail::accumulate_norm(a.data(), a.size(), mode);
+}
+
+}; // end namespace vecmat
+
+#endif
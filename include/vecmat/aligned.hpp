@@ -0,0 +1,169 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_ALIGNED_H
+#define VECMAT_ALIGNED_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <utility>
+
+/** ## Fixed size storage alignment
+ *
+ * By default the fixed size `vector` and `matrix` only have the
+ * natural alignment of their elements, so their storage is exactly a
+ * tightly packed C array (as OpenGL and friends expect) and any such
+ * array may be reinterpreted as one.  Defining `VECMAT_ALIGNMENT` to
+ * 16, 32, or 64 before including any header aligns the storage to the
+ * largest power of two up to that bound which divides its size.  A
+ * `mat4<float>` then sits on a single cache line and a `vec4<float>`
+ * in a single SSE register, while the sizes, and with them the
+ * packing of arrays, are unchanged.  Like the bounds check policy,
+ * every translation unit of a program must agree on it.
+ */
+#if !defined(VECMAT_ALIGNMENT)
+#define VECMAT_ALIGNMENT 0
+#endif
+
+namespace vecmat {
+
+namespace detail {
+
+/** The alignment of the storage of `N` elements of type `T` when
+ * capped at `Cap` bytes
+ */
+template <typename T, size_t N, size_t Cap = VECMAT_ALIGNMENT>
+struct storage_alignment {
+    static_assert(Cap == 0 || Cap == 16 || Cap == 32 || Cap == 64,
+                  "VECMAT_ALIGNMENT must be 0, 16, 32, or 64");
+
+    static const size_t bytes = N * sizeof(T);
+    static const size_t low = bytes & (~bytes + 1);
+    static const size_t fit = low < Cap ? low : Cap;
+    static const size_t value = fit > alignof(T) ? fit : alignof(T);
+};
+
+}; // end namespace detail
+
+/** An allocator returning storage aligned to `Align` bytes
+ *
+ * The default of 64 bytes is a cache line on every target we care
+ * about and wide enough for any SIMD register.  We over allocate and
+ * keep the pointer returned by `malloc` just before the aligned block
+ * so this works with any C++11 standard library.
+ */
+template <typename T, size_t Align = 64>
+struct aligned_allocator {
+    static_assert(Align >= sizeof(void *) && (Align & (Align - 1)) == 0,
+                  "alignment must be a power of two of at least a pointer");
+
+    typedef T value_type;
+    template <typename U>
+    struct rebind {
+        typedef aligned_allocator<U, Align> other;
+    };
+
+    aligned_allocator(void) noexcept {}
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Align> &) noexcept {}
+
+    T * allocate(size_t n)
+    {
+        if (n > (std::numeric_limits<size_t>::max() - Align) / sizeof(T))
+            throw std::bad_alloc();
+
+        void * raw = std::malloc(n * sizeof(T) + Align);
+        if (!raw)
+            throw std::bad_alloc();
+
+        uintptr_t p = reinterpret_cast<uintptr_t>(raw) + Align;
+        p &= ~static_cast<uintptr_t>(Align - 1);
+        reinterpret_cast<void **>(p)[-1] = raw;
+        return reinterpret_cast<T *>(p);
+    }
+    void deallocate(T * p, size_t) noexcept
+    {
+        if (p)
+            std::free(reinterpret_cast<void **>(p)[-1]);
+    }
+};
+
+template <typename T, typename U, size_t Align>
+bool operator==(const aligned_allocator<T, Align> &,
+                const aligned_allocator<U, Align> &)
+{
+    return true;
+}
+template <typename T, typename U, size_t Align>
+bool operator!=(const aligned_allocator<T, Align> &,
+                const aligned_allocator<U, Align> &)
+{
+    return false;
+}
+
+namespace detail {
+
+/** An aligned allocator that default initializes
+ *
+ * Containers value initialize the elements they add without a value,
+ * which zeros numbers.  This one leaves them as default initialized so
+ * the dynamic types can allocate storage they are about to overwrite
+ * without writing it twice.
+ */
+template <typename T, size_t Align = 64>
+struct default_init_allocator : aligned_allocator<T, Align> {
+    template <typename U>
+    struct rebind {
+        typedef default_init_allocator<U, Align> other;
+    };
+
+    default_init_allocator(void) noexcept {}
+    template <typename U>
+    default_init_allocator(const default_init_allocator<U, Align> &)
+        noexcept {}
+
+    template <typename U>
+    void construct(U * p)
+    {
+        ::new (static_cast<void *>(p)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U * p, Args &&... args)
+    {
+        ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
+}; // end namespace detail
+
+}; // end namespace vecmat
+
+#endif
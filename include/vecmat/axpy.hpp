@@ -0,0 +1,224 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_AXPY_H
+#define VECMAT_AXPY_H
+
+#include <cstdlib>
+#include <stdexcept>
+
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/stream.hpp"
+#include "vecmat/vector.hpp"
+
+namespace vecmat {
+
+/** # Level 1 updates
+ *
+ * The updates of iterative methods written with the operators, such as
+ * `y += a * x`, make a temporary and two passes over memory.  These
+ * work in place in a single pass and fuse the multiply and add where
+ * the processor can, which also rounds once instead of twice.
+ *
+ * * `axpy(a, x, y)` computes `y = a x + y`
+ * * `axpby(a, x, b, y)` computes `y = a x + b y`
+ * * `scal(a, x)` computes `x = a x`
+ * * `fma(a, b, c)` returns the element-wise `a b + c`
+ *
+ * The scalars are converted to the element type.  The updates return
+ * the object they modify.  The dynamic types throw
+ * `std::out_of_range` when the shapes differ.
+ */
+
+/** ## Fixed size vectors
+ */
+template <size_t N, typename T, typename U>
+vector<N, T> & axpy(const U & a, const vector<N, T> & x, vector<N, T> & y)
+{
+    simd::axpy(N, static_cast<T>(a), x.data, y.data);
+    return y;
+}
+
+template <size_t N, typename T, typename U, typename V>
+vector<N, T> & axpby(const U & a, const vector<N, T> & x, const V & b,
+                     vector<N, T> & y)
+{
+    simd::axpby(N, static_cast<T>(a), x.data, static_cast<T>(b), y.data);
+    return y;
+}
+
+template <size_t N, typename T, typename U>
+vector<N, T> & scal(const U & a, vector<N, T> & x)
+{
+    simd::broadcast<simd::multiplies>(x.data, static_cast<T>(a), N);
+    return x;
+}
+
+template <size_t N, typename T>
+vector<N, T> fma(const vector<N, T> & a, const vector<N, T> & b,
+                 const vector<N, T> & c)
+{
+    vector<N, T> d;
+    simd::fma(N, a.data, b.data, c.data, d.data);
+    return d;
+}
+
+/** ## Fixed size matrices
+ */
+template <size_t N, size_t M, typename T, typename U>
+matrix<N, M, T> & axpy(const U & a, const matrix<N, M, T> & x,
+                       matrix<N, M, T> & y)
+{
+    simd::axpy(N * M, static_cast<T>(a), x.data, y.data);
+    return y;
+}
+
+template <size_t N, size_t M, typename T, typename U, typename V>
+matrix<N, M, T> & axpby(const U & a, const matrix<N, M, T> & x,
+                        const V & b, matrix<N, M, T> & y)
+{
+    simd::axpby(N * M, static_cast<T>(a), x.data, static_cast<T>(b),
+                y.data);
+    return y;
+}
+
+template <size_t N, size_t M, typename T, typename U>
+matrix<N, M, T> & scal(const U & a, matrix<N, M, T> & x)
+{
+    simd::broadcast<simd::multiplies>(x.data, static_cast<T>(a), N * M);
+    return x;
+}
+
+template <size_t N, size_t M, typename T>
+matrix<N, M, T> fma(const matrix<N, M, T> & a, const matrix<N, M, T> & b,
+                    const matrix<N, M, T> & c)
+{
+    matrix<N, M, T> d;
+    simd::fma(N * M, a.data, b.data, c.data, d.data);
+    return d;
+}
+
+/** ## Dynamic vectors
+ */
+template <typename T, typename U>
+dvector<T> & axpy(const U & a, const dvector<T> & x, dvector<T> & y)
+{
+    if (x.size() != y.size())
+        throw std::out_of_range(__func__);
+    simd::axpy(y.size(), static_cast<T>(a), x.data(), y.data());
+    return y;
+}
+
+template <typename T, typename U, typename V>
+dvector<T> & axpby(const U & a, const dvector<T> & x, const V & b,
+                   dvector<T> & y)
+{
+    if (x.size() != y.size())
+        throw std::out_of_range(__func__);
+    simd::axpby(y.size(), static_cast<T>(a), x.data(),
+                static_cast<T>(b), y.data());
+    return y;
+}
+
+template <typename T, typename U>
+dvector<T> & scal(const U & a, dvector<T> & x)
+{
+    simd::broadcast<simd::multiplies>(x.data(), static_cast<T>(a),
+                                      x.size());
+    return x;
+}
+
+template <typename T>
+dvector<T> fma(const dvector<T> & a, const dvector<T> & b,
+               const dvector<T> & c)
+{
+    if (a.size() != b.size() || a.size() != c.size())
+        throw std::out_of_range(__func__);
+    dvector<T> d(a.size(), detail::uninitialized_t());
+    detail::fma_into(d.size(), a.data(), b.data(), c.data(), d.data());
+    return d;
+}
+
+/** ## Dynamic matrices
+ */
+namespace detail {
+
+template <typename T>
+void check_shape(const dmatrix<T> & a, const dmatrix<T> & b,
+                 const char * func)
+{
+    if (a.rows() != b.rows() || a.cols() != b.cols())
+        throw std::out_of_range(func);
+}
+
+}; // end namespace detail
+
+template <typename T, typename U>
+dmatrix<T> & axpy(const U & a, const dmatrix<T> & x, dmatrix<T> & y)
+{
+    detail::check_shape(x, y, __func__);
+    simd::axpy(y.size(), static_cast<T>(a), x.data(), y.data());
+    return y;
+}
+
+template <typename T, typename U, typename V>
+dmatrix<T> & axpby(const U & a, const dmatrix<T> & x, const V & b,
+                   dmatrix<T> & y)
+{
+    detail::check_shape(x, y, __func__);
+    simd::axpby(y.size(), static_cast<T>(a), x.data(),
+                static_cast<T>(b), y.data());
+    return y;
+}
+
+template <typename T, typename U>
+dmatrix<T> & scal(const U & a, dmatrix<T> & x)
+{
+    simd::broadcast<simd::multiplies>(x.data(), static_cast<T>(a),
+                                      x.size());
+    return x;
+}
+
+template <typename T>
+dmatrix<T> fma(const dmatrix<T> & a, const dmatrix<T> & b,
+               const dmatrix<T> & c)
+{
+    detail::check_shape(a, b, __func__);
+    detail::check_shape(a, c, __func__);
+    dmatrix<T> d(a.rows(), a.cols(), detail::uninitialized_t());
+    detail::fma_into(d.size(), a.data(), b.data(), c.data(), d.data());
+    return d;
+}
+
+}; // end namespace vecmat
+
+#endif
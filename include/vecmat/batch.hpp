@@ -0,0 +1,423 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_BATCH_H
+#define VECMAT_BATCH_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vecmat/aligned.hpp"
+#include "vecmat/bounds.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/map.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/vector.hpp"
+
+namespace vecmat {
+
+template <size_t N, typename T>
+class vector_batch {
+    /** Many vectors stored component by component
+     *
+     * An array of `vector<3, float>` interleaves the components, so a
+     * SIMD register loaded from it holds parts of different points.
+     * Here each component has its own lane: all the x components, then
+     * all the y components, and so on (structure of arrays).  A register
+     * loaded from a lane holds the same component of consecutive
+     * vectors, so one instruction works on 4, 8, or 16 vectors at once.
+     *
+     * The lanes share one 64 byte aligned block and each is padded to a
+     * whole number of cache lines.  The kernels run over the padding
+     * instead of finishing with a scalar loop, so the padding holds
+     * meaningless values.  Element `i` is a `vector_ref` striding across
+     * the lanes.
+     *
+     * Operations between batches of different sizes throw
+     * std::out_of_range.
+     */
+public:
+    typedef T type_t;                //! The base type of the vectors
+    typedef simd::pack<T> pack_t;    //! The pack used by the kernels
+
+    /** ## Construction
+     *
+     * A new batch is filled with zeros unless told otherwise.  Use
+     * `to_soa` to build one from an array of vectors.
+     */
+    vector_batch(void) : count(0), stride(0) {}
+    explicit vector_batch(size_t n, const vector<N, T> & a = vector<N, T>())
+        : count(n), stride(padded(n)), store(N * padded(n))
+    {
+        for (size_t k = 0; k < N; ++k)
+            std::fill(lane(k), lane(k) + count, a.data[k]);
+    }
+
+    /** ## Size and data
+     */
+    size_t size(void) const
+    {
+        return count;
+    }
+    /** The distance between the lanes */
+    size_t lane_stride(void) const
+    {
+        return stride;
+    }
+    T * lane(size_t k)
+    {
+        return store.data() + k * stride;
+    }
+    const T * lane(size_t k) const
+    {
+        return store.data() + k * stride;
+    }
+    void resize(size_t n)
+    {
+        vector_batch b(n);
+        for (size_t k = 0; k < N; ++k)
+            std::copy(lane(k), lane(k) + std::min(n, count), b.lane(k));
+        *this = std::move(b);
+    }
+
+    /** ## Access operations
+     *
+     * The index is checked according to `VECMAT_BOUNDS_CHECK`.
+     */
+    vector_ref<N, T> operator[](const size_t & i)
+    {
+        detail::check_bounds(i, count, __func__);
+        return vector_ref<N, T>(store.data() + i, stride);
+    }
+    vector_ref<N, const T> operator[](const size_t & i) const
+    {
+        detail::check_bounds(i, count, __func__);
+        return vector_ref<N, const T>(store.data() + i, stride);
+    }
+
+    /** ## Unary operator
+     */
+    vector_batch operator-() const &
+    {
+        vector_batch b(*this);
+        return -std::move(b);
+    }
+    vector_batch operator-() &&
+    {
+        simd::broadcast<simd::multiplies>(store.data(), static_cast<T>(-1),
+                                          store.size());
+        return std::move(*this);
+    }
+
+    /** ## Compound assignment
+     *
+     * A scalar applies to every component and a `vector` applies
+     * component by component to every element.
+     */
+    vector_batch & operator+=(const T & a)
+    {
+        simd::broadcast<simd::plus>(store.data(), a, store.size());
+        return *this;
+    }
+    vector_batch & operator-=(const T & a)
+    {
+        simd::broadcast<simd::minus>(store.data(), a, store.size());
+        return *this;
+    }
+    vector_batch & operator*=(const T & a)
+    {
+        simd::broadcast<simd::multiplies>(store.data(), a, store.size());
+        return *this;
+    }
+    vector_batch & operator/=(const T & a)
+    {
+        simd::broadcast<simd::divides>(store.data(), a, store.size());
+        return *this;
+    }
+    vector_batch & operator+=(const vector<N, T> & a)
+    {
+        for (size_t k = 0; k < N; ++k)
+            simd::broadcast<simd::plus>(lane(k), a.data[k], stride);
+        return *this;
+    }
+    vector_batch & operator-=(const vector<N, T> & a)
+    {
+        for (size_t k = 0; k < N; ++k)
+            simd::broadcast<simd::minus>(lane(k), a.data[k], stride);
+        return *this;
+    }
+    vector_batch & operator*=(const vector<N, T> & a)
+    {
+        for (size_t k = 0; k < N; ++k)
+            simd::broadcast<simd::multiplies>(lane(k), a.data[k], stride);
+        return *this;
+    }
+    vector_batch & operator/=(const vector<N, T> & a)
+    {
+        for (size_t k = 0; k < N; ++k)
+            simd::broadcast<simd::divides>(lane(k), a.data[k], stride);
+        return *this;
+    }
+    vector_batch & operator+=(const vector_batch & a)
+    {
+        check(a);
+        simd::transform<simd::plus>(store.data(), a.store.data(),
+                                    store.size());
+        return *this;
+    }
+    vector_batch & operator-=(const vector_batch & a)
+    {
+        check(a);
+        simd::transform<simd::minus>(store.data(), a.store.data(),
+                                     store.size());
+        return *this;
+    }
+    vector_batch & operator*=(const vector_batch & a)
+    {
+        check(a);
+        simd::transform<simd::multiplies>(store.data(), a.store.data(),
+                                          store.size());
+        return *this;
+    }
+    /** The padding of the divisor may be zero, which traps for
+     * integers, so division stops at the last element of each lane.
+     */
+    vector_batch & operator/=(const vector_batch & a)
+    {
+        check(a);
+        for (size_t k = 0; k < N; ++k)
+            simd::transform<simd::divides>(lane(k), a.lane(k), count);
+        return *this;
+    }
+
+    void check(const vector_batch & a) const
+    {
+        if (a.count != count)
+            throw std::out_of_range(__func__);
+    }
+
+private:
+    /** Round up to a whole number of cache lines
+     */
+    static size_t padded(size_t n)
+    {
+        const size_t line = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+        static_assert(sizeof(T) >= 64 || (64 / sizeof(T)) %
+                      simd::pack<T>::width == 0,
+                      "a pack must evenly divide a cache line");
+        return (n + line - 1) / line * line;
+    }
+
+    size_t count;   //! The number of vectors
+    size_t stride;  //! The distance between lanes
+    std::vector<T, aligned_allocator<T> > store;
+};
+
+/** ## Conversion
+ *
+ * Move between an array of vectors and a batch.
+ */
+template <size_t N, typename T>
+vector_batch<N, T> to_soa(const vector<N, T> * a, size_t count)
+{
+    vector_batch<N, T> b(count);
+    for (size_t k = 0; k < N; ++k)
+    {
+        T * lane = b.lane(k);
+        for (size_t i = 0; i < count; ++i)
+            lane[i] = a[i].data[k];
+    }
+    return b;
+}
+
+template <size_t N, typename T>
+void to_aos(const vector_batch<N, T> & a, vector<N, T> * b)
+{
+    for (size_t k = 0; k < N; ++k)
+    {
+        const T * lane = a.lane(k);
+        for (size_t i = 0; i < a.size(); ++i)
+            b[i].data[k] = lane[i];
+    }
+}
+
+/** ## Binary operators
+ *
+ * These follow `dvector`: the left operand is taken by value so a
+ * temporary is reused for the result.
+ */
+#define VECMAT_BATCH_OPERATOR(SYMBOL)                                       \
+template <size_t N, typename T>                                             \
+vector_batch<N, T> operator SYMBOL(vector_batch<N, T> a,                    \
+                                   const vector_batch<N, T> & b)            \
+{                                                                           \
+    a SYMBOL##= b;                                                          \
+    return a;                                                               \
+}                                                                           \
+template <size_t N, typename T>                                             \
+vector_batch<N, T> operator SYMBOL(vector_batch<N, T> a,                    \
+                                   const vector<N, T> & b)                  \
+{                                                                           \
+    a SYMBOL##= b;                                                          \
+    return a;                                                               \
+}                                                                           \
+template <size_t N, typename T, typename U>                                 \
+typename std::enable_if<is_scalar<U>::value, vector_batch<N, T> >::type     \
+operator SYMBOL(vector_batch<N, T> a, const U & b)                          \
+{                                                                           \
+    a SYMBOL##= static_cast<T>(b);                                          \
+    return a;                                                               \
+}
+
+VECMAT_BATCH_OPERATOR(+)
+VECMAT_BATCH_OPERATOR(-)
+VECMAT_BATCH_OPERATOR(*)
+VECMAT_BATCH_OPERATOR(/)
+
+#undef VECMAT_BATCH_OPERATOR
+
+template <size_t N, typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, vector_batch<N, T> >::type
+operator+(const U & a, vector_batch<N, T> b)
+{
+    b += static_cast<T>(a);
+    return b;
+}
+template <size_t N, typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, vector_batch<N, T> >::type
+operator*(const U & a, vector_batch<N, T> b)
+{
+    b *= static_cast<T>(a);
+    return b;
+}
+
+/** ### Comparison operators
+ */
+template <size_t N, typename T>
+bool operator==(const vector_batch<N, T> & a, const vector_batch<N, T> & b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t k = 0; k < N; ++k)
+        if (!std::equal(a.lane(k), a.lane(k) + a.size(), b.lane(k)))
+            return false;
+    return true;
+}
+template <size_t N, typename T>
+bool operator!=(const vector_batch<N, T> & a, const vector_batch<N, T> & b)
+{
+    return ! operator==(a, b);
+}
+
+/** ## Products
+ *
+ * One pass over the lanes computes a full pack of results at a time.
+ */
+/**
+ * @brief The inner product of matching elements
+ */
+template <size_t N, typename T>
+dvector<T> dot(const vector_batch<N, T> & a, const vector_batch<N, T> & b)
+{
+    typedef typename vector_batch<N, T>::pack_t P;
+    a.check(b);
+
+    dvector<T> c(a.lane_stride());
+    for (size_t i = 0; i < a.lane_stride(); i += P::width)
+    {
+        typename P::type r = P::mul(P::loadu(a.lane(0) + i),
+                                    P::loadu(b.lane(0) + i));
+        for (size_t k = 1; k < N; ++k)
+            r = P::fmadd(P::loadu(a.lane(k) + i), P::loadu(b.lane(k) + i),
+                         r);
+        P::storeu(c.data() + i, r);
+    }
+    c.resize(a.size());
+    return c;
+}
+
+/**
+ * @brief The cross product of matching elements
+ *
+ * Like `cross` for single vectors, the two dimensional components are
+ * taken to lie in the plane, so the result is always three dimensional.
+ */
+template <size_t N, typename T>
+vector_batch<3, T> cross(const vector_batch<N, T> & a,
+                         const vector_batch<N, T> & b)
+{
+    static_assert(N == 2 || N == 3, "cross needs two or three components");
+    typedef typename vector_batch<N, T>::pack_t P;
+    a.check(b);
+
+    vector_batch<3, T> c(a.size());
+    for (size_t i = 0; i < a.lane_stride(); i += P::width)
+    {
+        const typename P::type ax = P::loadu(a.lane(0) + i);
+        const typename P::type ay = P::loadu(a.lane(1) + i);
+        const typename P::type bx = P::loadu(b.lane(0) + i);
+        const typename P::type by = P::loadu(b.lane(1) + i);
+        if (N == 3)
+        {
+            const typename P::type az = P::loadu(a.lane(N - 1) + i);
+            const typename P::type bz = P::loadu(b.lane(N - 1) + i);
+            P::storeu(c.lane(0) + i, P::sub(P::mul(ay, bz), P::mul(az, by)));
+            P::storeu(c.lane(1) + i, P::sub(P::mul(az, bx), P::mul(ax, bz)));
+        }
+        P::storeu(c.lane(2) + i, P::sub(P::mul(ax, by), P::mul(ay, bx)));
+    }
+    return c;
+}
+
+/**
+ * @brief Resize and cast every element
+ *
+ * Follows `resize_cast` on single vectors: extra components are zero.
+ */
+template <size_t N, typename T, size_t M, typename U>
+vector_batch<N, T> resize_cast(const vector_batch<M, U> & a)
+{
+    vector_batch<N, T> b(a.size());
+    for (size_t k = 0; k < N && k < M; ++k)
+    {
+        const U * x = a.lane(k);
+        T * y = b.lane(k);
+        for (size_t i = 0; i < a.size(); ++i)
+            y[i] = static_cast<T>(x[i]);
+    }
+    return b;
+}
+
+}; // end namespace vecmat
+
+#endif
@@ -0,0 +1,192 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_BLAS_H
+#define VECMAT_BLAS_H
+
+#include <climits>
+#include <cstdlib>
+
+/** ## BLAS backend
+ *
+ * Defining `VECMAT_USE_BLAS` (and linking a BLAS library) hands the
+ * general products with at least `VECMAT_BLAS_THRESHOLD` multiply-adds
+ * to `sgemm`/`dgemm` and `sgemv`/`dgemv`.  Smaller products, and types
+ * the BLAS does not cover, keep the inline kernels.  The library is
+ * expected to use the usual Fortran calling convention with 32 bit
+ * integers.
+ */
+#if ! defined(VECMAT_BLAS_THRESHOLD)
+#define VECMAT_BLAS_THRESHOLD (64 * 64 * 64)
+#endif
+
+#if defined(VECMAT_USE_BLAS)
+
+extern "C" {
+void sgemm_(const char * transa, const char * transb,
+            const int * m, const int * n, const int * k,
+            const float * alpha, const float * a, const int * lda,
+            const float * b, const int * ldb,
+            const float * beta, float * c, const int * ldc);
+void dgemm_(const char * transa, const char * transb,
+            const int * m, const int * n, const int * k,
+            const double * alpha, const double * a, const int * lda,
+            const double * b, const int * ldb,
+            const double * beta, double * c, const int * ldc);
+void sgemv_(const char * trans, const int * m, const int * n,
+            const float * alpha, const float * a, const int * lda,
+            const float * x, const int * incx,
+            const float * beta, float * y, const int * incy);
+void dgemv_(const char * trans, const int * m, const int * n,
+            const double * alpha, const double * a, const int * lda,
+            const double * x, const int * incx,
+            const double * beta, double * y, const int * incy);
+}
+
+namespace vecmat {
+
+namespace detail {
+
+/** Products with fewer multiply-adds than this stay inline */
+static const size_t blas_threshold = VECMAT_BLAS_THRESHOLD;
+
+/** Whether every dimension fits the BLAS integer type
+ */
+inline bool blas_fits(size_t a, size_t b, size_t c, size_t d)
+{
+    const size_t limit = INT_MAX;
+    return a <= limit && b <= limit && c <= limit && d <= limit;
+}
+
+/** ### Matrix-matrix products
+ *
+ * Compute `c = op(a) op(b)` with the arguments of `vecmat::gemm`.
+ * Return false, leaving the work to the caller, when the product is
+ * small, the type has no BLAS routine, or a dimension is too large.
+ */
+template <typename T>
+bool blas_gemm(bool, bool, size_t, size_t, size_t, const T *, size_t,
+               const T *, size_t, T *, size_t)
+{
+    return false;
+}
+
+template <typename T, typename F>
+bool call_gemm(F f, bool transa, bool transb,
+               size_t m, size_t n, size_t k,
+               const T * a, size_t lda,
+               const T * b, size_t ldb,
+               T * c, size_t ldc)
+{
+    if (m * n * k < blas_threshold || ! blas_fits(m, n, k, lda) ||
+        ! blas_fits(ldb, ldc, 0, 0))
+        return false;
+
+    const char ta = transa ? 'T' : 'N';
+    const char tb = transb ? 'T' : 'N';
+    const int im = static_cast<int>(m);
+    const int in = static_cast<int>(n);
+    const int ik = static_cast<int>(k);
+    const int ilda = static_cast<int>(lda);
+    const int ildb = static_cast<int>(ldb);
+    const int ildc = static_cast<int>(ldc);
+    const T alpha = 1;
+    const T beta = 0;
+    f(&ta, &tb, &im, &in, &ik, &alpha, a, &ilda, b, &ildb, &beta, c,
+      &ildc);
+    return true;
+}
+
+inline bool blas_gemm(bool transa, bool transb,
+                      size_t m, size_t n, size_t k,
+                      const float * a, size_t lda,
+                      const float * b, size_t ldb,
+                      float * c, size_t ldc)
+{
+    return call_gemm(sgemm_, transa, transb, m, n, k, a, lda, b, ldb,
+                     c, ldc);
+}
+
+inline bool blas_gemm(bool transa, bool transb,
+                      size_t m, size_t n, size_t k,
+                      const double * a, size_t lda,
+                      const double * b, size_t ldb,
+                      double * c, size_t ldc)
+{
+    return call_gemm(dgemm_, transa, transb, m, n, k, a, lda, b, ldb,
+                     c, ldc);
+}
+
+/** ### Matrix-vector products
+ *
+ * Compute `y = op(a) x` with the arguments of `vecmat::gemv`.
+ */
+template <typename T>
+bool blas_gemv(bool, size_t, size_t, const T *, size_t, const T *, T *)
+{
+    return false;
+}
+
+template <typename T, typename F>
+bool call_gemv(F f, bool trans, size_t m, size_t n, const T * a,
+               size_t lda, const T * x, T * y)
+{
+    if (m * n < blas_threshold || ! blas_fits(m, n, lda, 0))
+        return false;
+
+    const char t = trans ? 'T' : 'N';
+    const int im = static_cast<int>(m);
+    const int in = static_cast<int>(n);
+    const int ilda = static_cast<int>(lda);
+    const int inc = 1;
+    const T alpha = 1;
+    const T beta = 0;
+    f(&t, &im, &in, &alpha, a, &ilda, x, &inc, &beta, y, &inc);
+    return true;
+}
+
+inline bool blas_gemv(bool trans, size_t m, size_t n, const float * a,
+                      size_t lda, const float * x, float * y)
+{
+    return call_gemv(sgemv_, trans, m, n, a, lda, x, y);
+}
+
+inline bool blas_gemv(bool trans, size_t m, size_t n, const double * a,
+                      size_t lda, const double * x, double * y)
+{
+    return call_gemv(dgemv_, trans, m, n, a, lda, x, y);
+}
+
+}; // end namespace detail
+
+}; // end namespace vecmat
+
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_BOUNDS_H
+#define VECMAT_BOUNDS_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "vecmat/simd.hpp"
+
+/** ## Bounds checking policy
+ *
+ * Element access (`[i]`, `(i)`, and `(i, j)`) and the slices of
+ * `vecmat/slice.hpp` check their indices according to
+ * `VECMAT_BOUNDS_CHECK`, which may be defined before including any
+ * header to one of
+ *
+ * - `VECMAT_BOUNDS_UNCHECKED`: no check.  The index is instead promised
+ *   to the optimizer so loops over elements stay branch free.
+ * - `VECMAT_BOUNDS_THROW`: throw std::out_of_range.
+ * - `VECMAT_BOUNDS_ABORT`: report the failing function on `stderr` and
+ *   abort, which leaves the offending frame in a debugger or core file.
+ *
+ * The default follows `assert`: unchecked under `NDEBUG` and throwing
+ * otherwise.  Since the policy changes code inside inline functions,
+ * every translation unit of a program must agree on it.  The library
+ * kernels never go through the checked access.
+ */
+#define VECMAT_BOUNDS_UNCHECKED 0
+#define VECMAT_BOUNDS_THROW 1
+#define VECMAT_BOUNDS_ABORT 2
+
+#if !defined(VECMAT_BOUNDS_CHECK)
+#if defined(NDEBUG)
+#define VECMAT_BOUNDS_CHECK VECMAT_BOUNDS_UNCHECKED
+#else
+#define VECMAT_BOUNDS_CHECK VECMAT_BOUNDS_THROW
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define VECMAT_ASSUME(c) __assume(c)
+#elif defined(__GNUC__)
+#define VECMAT_ASSUME(c) \
+    do { if (!(c)) __builtin_unreachable(); } while (0)
+#else
+#define VECMAT_ASSUME(c) ((void)0)
+#endif
+
+namespace vecmat {
+
+namespace detail {
+
+/** Apply the bounds checking policy to index `i` of an `n` element
+ * object on behalf of `func`
+ */
+VECMAT_CONSTEXPR inline void check_bounds(size_t i, size_t n,
+                                          const char * func)
+{
+#if VECMAT_BOUNDS_CHECK == VECMAT_BOUNDS_THROW
+    if (i >= n)
+        throw std::out_of_range(func);
+#elif VECMAT_BOUNDS_CHECK == VECMAT_BOUNDS_ABORT
+    if (i >= n)
+    {
+        std::fprintf(stderr, "vecmat: index out of range in %s\n", func);
+        std::abort();
+    }
+#else
+    (void)func;
+    VECMAT_ASSUME(i < n);
+#endif
+}
+
+}; // end namespace detail
+
+}; // end namespace vecmat
+
+#endif
@@ -0,0 +1,461 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_DISPATCH_H
+#define VECMAT_DISPATCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#include "vecmat/simd.hpp"
+
+#if defined(VECMAT_DISPATCH_X86)
+
+namespace vecmat {
+
+/** ## Instruction sets
+ *
+ * The levels the run time dispatch chooses between, in order.  The
+ * baseline is whatever the compiler flags allow.
+ */
+enum isa_t {
+    isa_baseline = 0,
+    isa_avx2 = 1,
+    isa_avx512 = 2
+};
+
+namespace simd {
+
+namespace dispatch {
+
+/** The level the rest of the library was compiled for
+ *
+ * Kernels at or below it are no better than the inline ones, so they
+ * are never selected.
+ */
+#if defined(VECMAT_AVX512)
+static const isa_t compiled_isa = isa_avx512;
+#elif defined(VECMAT_AVX2) && defined(VECMAT_FMA)
+static const isa_t compiled_isa = isa_avx2;
+#else
+static const isa_t compiled_isa = isa_baseline;
+#endif
+
+/** Arrays shorter than this stay with the inline kernels since the
+ * indirect call would cost more than the wider registers save.
+ */
+static const size_t dispatch_threshold = 64;
+
+/** Batches of fewer 4x4 columns stay inline, which keeps the matrix
+ * products on their unrolled path.
+ */
+static const size_t columns_threshold = 8;
+
+/** ## Processor detection
+ *
+ * The answer from `cpuid` (which includes whether the operating system
+ * saves the wider registers) is asked for once and kept.
+ */
+inline isa_t detect(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return isa_avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return isa_avx2;
+    return isa_baseline;
+}
+
+inline isa_t detected(void)
+{
+    static const isa_t isa = detect();
+    return isa;
+}
+
+/** The `VECMAT_ISA` environment variable caps the starting level at
+ * `baseline`, `avx2`, or `avx512`.
+ */
+inline isa_t initial(void)
+{
+    isa_t cap = isa_avx512;
+    if (const char * env = std::getenv("VECMAT_ISA"))
+    {
+        if (std::strcmp(env, "baseline") == 0)
+            cap = isa_baseline;
+        else if (std::strcmp(env, "avx2") == 0)
+            cap = isa_avx2;
+    }
+    return std::min(detected(), cap);
+}
+
+inline std::atomic<int> & state(void)
+{
+    static std::atomic<int> isa(initial());
+    return isa;
+}
+
+/** The slot of an element-wise operation in the tables below
+ */
+template <template <typename> class Op> struct op_index;
+template <> struct op_index<plus> { static const size_t value = 0; };
+template <> struct op_index<minus> { static const size_t value = 1; };
+template <> struct op_index<multiplies> { static const size_t value = 2; };
+template <> struct op_index<divides> { static const size_t value = 3; };
+
+template <size_t K>
+struct op_tag {};
+
+/** ## Kernels
+ *
+ * The element-wise kernels come from `dispatch_kernels.hpp`.  The 4x4
+ * column kernels are written out by hand so that a register holds as
+ * many columns as it can rather than one.  Like `mat4_columns` each
+ * group of columns is read before it is written, so `c` may be `b`.
+ */
+VECMAT_TARGET_AVX2_BEGIN
+#define VECMAT_DISPATCH_KERNELS avx2_kernels
+#define VECMAT_DISPATCH_PACK avx
+#include "vecmat/dispatch_kernels.hpp"
+#undef VECMAT_DISPATCH_KERNELS
+#undef VECMAT_DISPATCH_PACK
+
+struct avx2_columns {
+    static void mat4_columns(const float * a, const float * b, float * c,
+                             size_t count)
+    {
+        const __m128 * q = reinterpret_cast<const __m128 *>(a);
+        const __m256 a0 = _mm256_broadcast_ps(q);
+        const __m256 a1 = _mm256_broadcast_ps(q + 1);
+        const __m256 a2 = _mm256_broadcast_ps(q + 2);
+        const __m256 a3 = _mm256_broadcast_ps(q + 3);
+        size_t j = 0;
+        for (; j + 2 <= count; j += 2, b += 8, c += 8)
+        {
+            const __m256 x = _mm256_loadu_ps(b);
+            __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(x, 0x00));
+            r = _mm256_fmadd_ps(a1, _mm256_permute_ps(x, 0x55), r);
+            r = _mm256_fmadd_ps(a2, _mm256_permute_ps(x, 0xAA), r);
+            r = _mm256_fmadd_ps(a3, _mm256_permute_ps(x, 0xFF), r);
+            _mm256_storeu_ps(c, r);
+        }
+        if (j < count)
+        {
+            const __m128 x = _mm_loadu_ps(b);
+            __m128 r = _mm_mul_ps(_mm256_castps256_ps128(a0),
+                                  _mm_permute_ps(x, 0x00));
+            r = _mm_fmadd_ps(_mm256_castps256_ps128(a1),
+                             _mm_permute_ps(x, 0x55), r);
+            r = _mm_fmadd_ps(_mm256_castps256_ps128(a2),
+                             _mm_permute_ps(x, 0xAA), r);
+            r = _mm_fmadd_ps(_mm256_castps256_ps128(a3),
+                             _mm_permute_ps(x, 0xFF), r);
+            _mm_storeu_ps(c, r);
+        }
+    }
+
+    static void mat4_columns(const double * a, const double * b,
+                             double * c, size_t count)
+    {
+        const __m256d a0 = _mm256_loadu_pd(a);
+        const __m256d a1 = _mm256_loadu_pd(a + 4);
+        const __m256d a2 = _mm256_loadu_pd(a + 8);
+        const __m256d a3 = _mm256_loadu_pd(a + 12);
+        for (size_t j = 0; j < count; ++j, b += 4, c += 4)
+        {
+            const __m256d x = _mm256_loadu_pd(b);
+            __m256d r = _mm256_mul_pd(a0, _mm256_permute4x64_pd(x, 0x00));
+            r = _mm256_fmadd_pd(a1, _mm256_permute4x64_pd(x, 0x55), r);
+            r = _mm256_fmadd_pd(a2, _mm256_permute4x64_pd(x, 0xAA), r);
+            r = _mm256_fmadd_pd(a3, _mm256_permute4x64_pd(x, 0xFF), r);
+            _mm256_storeu_pd(c, r);
+        }
+    }
+};
+VECMAT_TARGET_END
+
+/** The permutes and broadcasts below trip the same GCC 12 warning as
+ * the AVX-512 packs in `simd.hpp`, so it is silenced for the region.
+ */
+VECMAT_TARGET_AVX512_BEGIN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#define VECMAT_DISPATCH_KERNELS avx512_kernels
+#define VECMAT_DISPATCH_PACK avx512
+#include "vecmat/dispatch_kernels.hpp"
+#undef VECMAT_DISPATCH_KERNELS
+#undef VECMAT_DISPATCH_PACK
+
+/** The partial group at the end is handled with a masked load and
+ * store rather than a scalar loop.
+ */
+struct avx512_columns {
+    static void mat4_columns(const float * a, const float * b, float * c,
+                             size_t count)
+    {
+        const __m512 a0 = _mm512_broadcast_f32x4(_mm_loadu_ps(a));
+        const __m512 a1 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 4));
+        const __m512 a2 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 8));
+        const __m512 a3 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 12));
+        size_t j = 0;
+        for (; j + 4 <= count; j += 4, b += 16, c += 16)
+        {
+            const __m512 x = _mm512_loadu_ps(b);
+            __m512 r = _mm512_mul_ps(a0, _mm512_permute_ps(x, 0x00));
+            r = _mm512_fmadd_ps(a1, _mm512_permute_ps(x, 0x55), r);
+            r = _mm512_fmadd_ps(a2, _mm512_permute_ps(x, 0xAA), r);
+            r = _mm512_fmadd_ps(a3, _mm512_permute_ps(x, 0xFF), r);
+            _mm512_storeu_ps(c, r);
+        }
+        if (j < count)
+        {
+            const __mmask16 k =
+                static_cast<__mmask16>((1u << (4 * (count - j))) - 1);
+            const __m512 x = _mm512_maskz_loadu_ps(k, b);
+            __m512 r = _mm512_mul_ps(a0, _mm512_permute_ps(x, 0x00));
+            r = _mm512_fmadd_ps(a1, _mm512_permute_ps(x, 0x55), r);
+            r = _mm512_fmadd_ps(a2, _mm512_permute_ps(x, 0xAA), r);
+            r = _mm512_fmadd_ps(a3, _mm512_permute_ps(x, 0xFF), r);
+            _mm512_mask_storeu_ps(c, k, r);
+        }
+    }
+
+    static void mat4_columns(const double * a, const double * b,
+                             double * c, size_t count)
+    {
+        const __m512d a0 = _mm512_broadcast_f64x4(_mm256_loadu_pd(a));
+        const __m512d a1 = _mm512_broadcast_f64x4(_mm256_loadu_pd(a + 4));
+        const __m512d a2 = _mm512_broadcast_f64x4(_mm256_loadu_pd(a + 8));
+        const __m512d a3 = _mm512_broadcast_f64x4(_mm256_loadu_pd(a + 12));
+        size_t j = 0;
+        for (; j + 2 <= count; j += 2, b += 8, c += 8)
+        {
+            const __m512d x = _mm512_loadu_pd(b);
+            __m512d r = _mm512_mul_pd(a0, _mm512_permutex_pd(x, 0x00));
+            r = _mm512_fmadd_pd(a1, _mm512_permutex_pd(x, 0x55), r);
+            r = _mm512_fmadd_pd(a2, _mm512_permutex_pd(x, 0xAA), r);
+            r = _mm512_fmadd_pd(a3, _mm512_permutex_pd(x, 0xFF), r);
+            _mm512_storeu_pd(c, r);
+        }
+        if (j < count)
+        {
+            const __mmask8 k = 0x0F;
+            const __m512d x = _mm512_maskz_loadu_pd(k, b);
+            __m512d r = _mm512_mul_pd(a0, _mm512_permutex_pd(x, 0x00));
+            r = _mm512_fmadd_pd(a1, _mm512_permutex_pd(x, 0x55), r);
+            r = _mm512_fmadd_pd(a2, _mm512_permutex_pd(x, 0xAA), r);
+            r = _mm512_fmadd_pd(a3, _mm512_permutex_pd(x, 0xFF), r);
+            _mm512_mask_storeu_pd(c, k, r);
+        }
+    }
+};
+#pragma GCC diagnostic pop
+VECMAT_TARGET_END
+
+/** ## Kernel tables
+ *
+ * One table per element type and level, built the first time the type
+ * is used.  A null entry means the inline kernel is used instead.
+ */
+template <typename T>
+struct kernels {
+    typedef void (*transform_fn)(T *, const T *, size_t);
+    typedef void (*broadcast_fn)(T *, T, size_t);
+    typedef T (*inner_fn)(const T *, const T *, size_t);
+    typedef void (*columns_fn)(const T *, const T *, T *, size_t);
+    typedef void (*lanes_fn)(const T *, const T * const *, T * const *,
+                             size_t, bool);
+
+    transform_fn transform[4];
+    broadcast_fn broadcast[4];
+    inner_fn inner;
+    columns_fn mat4_columns;
+    lanes_fn lanes3;
+    lanes_fn lanes4;
+};
+
+template <typename K, typename C, typename T>
+kernels<T> fill(void)
+{
+    kernels<T> k = kernels<T>();
+    k.transform[0] = &K::template transform<plus, T>;
+    k.transform[1] = &K::template transform<minus, T>;
+    k.transform[2] = &K::template transform<multiplies, T>;
+    k.transform[3] = &K::template transform<divides, T>;
+    k.broadcast[0] = &K::template broadcast<plus, T>;
+    k.broadcast[1] = &K::template broadcast<minus, T>;
+    k.broadcast[2] = &K::template broadcast<multiplies, T>;
+    k.broadcast[3] = &K::template broadcast<divides, T>;
+    k.inner = &K::template inner<T>;
+    k.mat4_columns = &C::mat4_columns;
+    k.lanes3 = &K::template transform_lanes<3, T>;
+    k.lanes4 = &K::template transform_lanes<4, T>;
+    return k;
+}
+
+/** Only the floating point types have kernels for every level
+ */
+template <typename T>
+kernels<T> select(isa_t)
+{
+    return kernels<T>();
+}
+template <typename T>
+kernels<T> select_floating(isa_t isa)
+{
+    if (isa <= compiled_isa)
+        return kernels<T>();
+    if (isa == isa_avx512)
+        return fill<avx512_kernels, avx512_columns, T>();
+    return fill<avx2_kernels, avx2_columns, T>();
+}
+template <>
+inline kernels<float> select<float>(isa_t isa)
+{
+    return select_floating<float>(isa);
+}
+template <>
+inline kernels<double> select<double>(isa_t isa)
+{
+    return select_floating<double>(isa);
+}
+
+template <typename T>
+const kernels<T> & active(void)
+{
+    static const kernels<T> table[] = {
+        select<T>(isa_baseline),
+        select<T>(isa_avx2),
+        select<T>(isa_avx512)
+    };
+    return table[state().load(std::memory_order_relaxed)];
+}
+
+/** ## Entry points
+ *
+ * These are called by the inline kernels and report whether they did
+ * the work.
+ */
+template <template <typename> class Op, typename T>
+bool transform(T * a, const T * b, size_t n)
+{
+    if (n < dispatch_threshold)
+        return false;
+    const typename kernels<T>::transform_fn f =
+        active<T>().transform[op_index<Op>::value];
+    if (! f)
+        return false;
+    f(a, b, n);
+    return true;
+}
+
+template <template <typename> class Op, typename T>
+bool broadcast(T * a, const T & b, size_t n)
+{
+    if (n < dispatch_threshold)
+        return false;
+    const typename kernels<T>::broadcast_fn f =
+        active<T>().broadcast[op_index<Op>::value];
+    if (! f)
+        return false;
+    f(a, b, n);
+    return true;
+}
+
+template <typename T>
+bool inner(const T * a, const T * b, size_t n, T & r)
+{
+    if (n < dispatch_threshold)
+        return false;
+    const typename kernels<T>::inner_fn f = active<T>().inner;
+    if (! f)
+        return false;
+    r = f(a, b, n);
+    return true;
+}
+
+template <typename T>
+bool mat4_columns(const T * a, const T * b, T * c, size_t count)
+{
+    if (count < columns_threshold)
+        return false;
+    const typename kernels<T>::columns_fn f = active<T>().mat4_columns;
+    if (! f)
+        return false;
+    f(a, b, c, count);
+    return true;
+}
+
+template <size_t N, typename T>
+bool transform_lanes(const T * m, const T * const * in, T * const * out,
+                     size_t count, bool divide)
+{
+    const kernels<T> & k = active<T>();
+    const typename kernels<T>::lanes_fn f = N == 3 ? k.lanes3 : k.lanes4;
+    if (! f)
+        return false;
+    f(m, in, out, count, divide);
+    return true;
+}
+
+}; // end namespace dispatch
+
+}; // end namespace simd
+
+/** ## Instruction set selection
+ *
+ * The level detected on this processor, and the level in use.  The
+ * level in use starts at the detected one (capped by `VECMAT_ISA`) and
+ * can be changed with `set_isa`, for instance to compare kernels.  It
+ * is never raised above what the processor supports, and the return
+ * value is the level actually selected.  Levels at or below the one
+ * the program was compiled for all run the inline kernels.
+ */
+inline isa_t detected_isa(void)
+{
+    return simd::dispatch::detected();
+}
+inline isa_t active_isa(void)
+{
+    return static_cast<isa_t>(simd::dispatch::state().load());
+}
+inline isa_t set_isa(isa_t isa)
+{
+    const isa_t level = std::min(isa, detected_isa());
+    simd::dispatch::state().store(level);
+    return level;
+}
+
+}; // end namespace vecmat
+
+#endif
+
+#endif
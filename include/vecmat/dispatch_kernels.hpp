@@ -0,0 +1,173 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** ## Instruction set specific kernels
+ *
+ * This file is included by `dispatch.hpp` once per instruction set,
+ * inside `vecmat::simd::dispatch` and inside the matching target
+ * region, so there is deliberately no include guard.  The includer
+ * names the struct with `VECMAT_DISPATCH_KERNELS` and the pack template
+ * with `VECMAT_DISPATCH_PACK`.  The bodies mirror the portable kernels
+ * in `simd.hpp` and `transform.hpp`.  Anything passing a register by
+ * value must be defined in the region too, so the operations are
+ * repeated here (selected by `op_index`) rather than taken from
+ * `plus` and friends.
+ */
+#if ! defined(VECMAT_DISPATCH_KERNELS) || ! defined(VECMAT_DISPATCH_PACK)
+#error "dispatch_kernels.hpp is only included by dispatch.hpp"
+#endif
+
+struct VECMAT_DISPATCH_KERNELS {
+    template <typename P>
+    static typename P::type apply(op_tag<0>, typename P::type a,
+                                  typename P::type b)
+    {
+        return P::add(a, b);
+    }
+    template <typename P>
+    static typename P::type apply(op_tag<1>, typename P::type a,
+                                  typename P::type b)
+    {
+        return P::sub(a, b);
+    }
+    template <typename P>
+    static typename P::type apply(op_tag<2>, typename P::type a,
+                                  typename P::type b)
+    {
+        return P::mul(a, b);
+    }
+    template <typename P>
+    static typename P::type apply(op_tag<3>, typename P::type a,
+                                  typename P::type b)
+    {
+        return P::div(a, b);
+    }
+
+    template <template <typename> class Op, typename T>
+    static void transform(T * a, const T * b, size_t n)
+    {
+        typedef VECMAT_DISPATCH_PACK<T> P;
+        typedef scalar<T> S;
+        const op_tag<op_index<Op>::value> tag;
+
+        const size_t m = n - n % P::width;
+        size_t i = 0;
+        for (; i < m; i += P::width)
+        {
+            const typename P::type x = P::loadu(a + i);
+            P::storeu(a + i, apply<P>(tag, x, P::loadu(b + i)));
+        }
+        for (; i < n; ++i)
+            a[i] = Op<S>::apply(a[i], b[i]);
+    }
+
+    template <template <typename> class Op, typename T>
+    static void broadcast(T * a, T b, size_t n)
+    {
+        typedef VECMAT_DISPATCH_PACK<T> P;
+        typedef scalar<T> S;
+        const op_tag<op_index<Op>::value> tag;
+
+        const typename P::type s = P::set1(b);
+        const size_t m = n - n % P::width;
+        size_t i = 0;
+        for (; i < m; i += P::width)
+            P::storeu(a + i, apply<P>(tag, P::loadu(a + i), s));
+        for (; i < n; ++i)
+            a[i] = Op<S>::apply(a[i], b);
+    }
+
+    /** Two accumulators hide the latency of the fused multiply-add
+     */
+    template <typename T>
+    static T inner(const T * a, const T * b, size_t n)
+    {
+        typedef VECMAT_DISPATCH_PACK<T> P;
+
+        typename P::type s0 = P::set1(T(0));
+        typename P::type s1 = s0;
+        const size_t m = n - n % (2 * P::width);
+        size_t i = 0;
+        for (; i < m; i += 2 * P::width)
+        {
+            s0 = P::fmadd(P::loadu(a + i), P::loadu(b + i), s0);
+            s1 = P::fmadd(P::loadu(a + i + P::width),
+                          P::loadu(b + i + P::width), s1);
+        }
+        if (i + P::width <= n)
+        {
+            s0 = P::fmadd(P::loadu(a + i), P::loadu(b + i), s0);
+            i += P::width;
+        }
+        T lanes[P::width];
+        P::storeu(lanes, P::add(s0, s1));
+        T r = 0;
+        for (size_t k = 0; k < P::width; ++k)
+            r += lanes[k];
+        for (; i < n; ++i)
+            r += a[i] * b[i];
+        return r;
+    }
+
+    template <size_t N, typename T>
+    static void transform_lanes(const T * m, const T * const * in,
+                                T * const * out, size_t count, bool divide)
+    {
+        typedef VECMAT_DISPATCH_PACK<T> P;
+        typename P::type a[4][4];
+        for (size_t j = 0; j < 4; ++j)
+            for (size_t i = 0; i < 4; ++i)
+                a[i][j] = P::set1(m[i + 4 * j]);
+
+        for (size_t k = 0; k < count; k += P::width)
+        {
+            typename P::type p[N];
+            for (size_t j = 0; j < N; ++j)
+                p[j] = P::loadu(in[j] + k);
+            typename P::type r[4];
+            for (size_t i = 0; i < 4; ++i)
+            {
+                r[i] = N == 4 ? P::mul(a[i][0], p[0])
+                              : P::fmadd(a[i][0], p[0], a[i][3]);
+                r[i] = P::fmadd(a[i][1], p[1], r[i]);
+                r[i] = P::fmadd(a[i][2], p[2], r[i]);
+                if (N == 4)
+                    r[i] = P::fmadd(a[i][3], p[N - 1], r[i]);
+            }
+            if (divide)
+            {
+                for (size_t i = 0; i < 3; ++i)
+                    r[i] = P::div(r[i], r[3]);
+                r[3] = P::div(r[3], r[3]);
+            }
+            for (size_t i = 0; i < N; ++i)
+                P::storeu(out[i] + k, r[i]);
+        }
+    }
+};
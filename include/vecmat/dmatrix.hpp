@@ -0,0 +1,528 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_DMATRIX_H
+#define VECMAT_DMATRIX_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vecmat/aligned.hpp"
+#include "vecmat/bounds.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/gemm.hpp"
+#include "vecmat/gemv.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/parallel.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/transpose.hpp"
+
+namespace vecmat {
+
+template <typename T>
+class dmatrix {
+    /** A matrix whose dimensions are chosen at runtime
+     *
+     * This is the counterpart of `matrix` for problems that are too big
+     * for the stack or whose size comes from input.  The data are
+     * stored column-major in a single 64 byte aligned block on the
+     * heap, and moves transfer the block.  As with `dvector`, the
+     * binary operators reuse the storage of temporary operands.
+     *
+     * Operations between matrices of incompatible dimensions throw
+     * std::out_of_range.
+     */
+public:
+    /** ## Type definitions
+     */
+    typedef T        type_t;         //! The base type of the matrix
+    typedef T*       iterator;       //! The iterator across the data
+    typedef const T* const_iterator; //! The iterator across the constant data
+
+    /** ## Construction
+     *
+     * The list constructor takes the elements in column-major order
+     * just like aggregate initialization of a `matrix`.  Missing
+     * elements are zero and excess elements throw std::out_of_range.
+     * As with `dvector`, the fills and copies of large matrices are
+     * split across the thread pool and streamed.
+     */
+    dmatrix(void) : n(0), m(0) {}
+    dmatrix(size_t rows, size_t cols, const T & a = T())
+        : n(rows), m(cols), store(rows * cols)
+    {
+        detail::parallel_fill(data(), a, size());
+    }
+    dmatrix(size_t rows, size_t cols, detail::uninitialized_t)
+        : n(rows), m(cols), store(rows * cols) {}
+    dmatrix(size_t rows, size_t cols, std::initializer_list<T> a)
+        : n(rows), m(cols), store(rows * cols, T())
+    {
+        if (a.size() > store.size())
+            throw std::out_of_range(__func__);
+        std::copy(a.begin(), a.end(), store.begin());
+    }
+    template <size_t N, size_t M>
+    dmatrix(const matrix<N, M, T> & a)
+        : n(N), m(M), store(a.cbegin(), a.cend()) {}
+    dmatrix(const dmatrix & a) : n(a.n), m(a.m), store(a.size())
+    {
+        detail::parallel_cast(data(), a.data(), size());
+    }
+    dmatrix(dmatrix &&) = default;
+
+    dmatrix & operator=(const dmatrix & a)
+    {
+        if (this == &a)
+            return *this;
+        if (a.size() > store.capacity())
+            store.clear();
+        store.resize(a.size());
+        n = a.n;
+        m = a.m;
+        detail::parallel_cast(data(), a.data(), size());
+        return *this;
+    }
+    dmatrix & operator=(dmatrix &&) = default;
+
+    /** ## Size and data
+     */
+    size_t rows(void) const
+    {
+        return n;
+    }
+    size_t cols(void) const
+    {
+        return m;
+    }
+    size_t size(void) const
+    {
+        return store.size();
+    }
+    T * data(void)
+    {
+        return store.data();
+    }
+    const T * data(void) const
+    {
+        return store.data();
+    }
+
+    /** ## Iterator access
+     */
+    iterator begin(void)
+    {
+        return data();
+    }
+    iterator end(void)
+    {
+        return data() + size();
+    }
+    const_iterator begin(void) const
+    {
+        return data();
+    }
+    const_iterator end(void) const
+    {
+        return data() + size();
+    }
+    const_iterator cbegin(void) const
+    {
+        return data();
+    }
+    const_iterator cend(void) const
+    {
+        return data() + size();
+    }
+
+    /** ## Access operations
+     *
+     * `[k]` addresses the column-major storage and `(i, j)` the `i`-th
+     * row and `j`-th column.  The indices are checked according to
+     * `VECMAT_BOUNDS_CHECK`.
+     */
+    const T & operator[](const size_t & k) const
+    {
+        detail::check_bounds(k, size(), __func__);
+        return store[k];
+    }
+    T & operator[](const size_t & k)
+    {
+        detail::check_bounds(k, size(), __func__);
+        return store[k];
+    }
+    const T & operator()(const size_t & i, const size_t & j) const
+    {
+        detail::check_bounds(i, n, __func__);
+        detail::check_bounds(j, m, __func__);
+        return store[i + j * n];
+    }
+    T & operator()(const size_t & i, const size_t & j)
+    {
+        detail::check_bounds(i, n, __func__);
+        detail::check_bounds(j, m, __func__);
+        return store[i + j * n];
+    }
+
+    /** ## Unary operator
+     */
+    dmatrix operator-() const &
+    {
+        dmatrix b(*this);
+        return -std::move(b);
+    }
+    dmatrix operator-() &&
+    {
+        detail::parallel_broadcast<simd::multiplies>(data(),
+                                                     static_cast<T>(-1),
+                                                     size());
+        return std::move(*this);
+    }
+
+    /** Scalar assignment
+     */
+    dmatrix & operator=(const T & a)
+    {
+        detail::parallel_fill(data(), a, size());
+        return *this;
+    }
+
+    /** ## Compound assignment
+     */
+    /** ### Scalar compound assignment
+     */
+    dmatrix & operator+=(const T & a)
+    {
+        detail::parallel_broadcast<simd::plus>(data(), a, size());
+        return *this;
+    }
+    dmatrix & operator-=(const T & a)
+    {
+        detail::parallel_broadcast<simd::minus>(data(), a, size());
+        return *this;
+    }
+    dmatrix & operator*=(const T & a)
+    {
+        detail::parallel_broadcast<simd::multiplies>(data(), a, size());
+        return *this;
+    }
+    dmatrix & operator/=(const T & a)
+    {
+        detail::parallel_broadcast<simd::divides>(data(), a, size());
+        return *this;
+    }
+
+    /** ### Matrix compound assignments
+     */
+    dmatrix & operator+=(const dmatrix & a)
+    {
+        check(a);
+        detail::parallel_transform<simd::plus>(data(), a.data(), size());
+        return *this;
+    }
+    dmatrix & operator-=(const dmatrix & a)
+    {
+        check(a);
+        detail::parallel_transform<simd::minus>(data(), a.data(), size());
+        return *this;
+    }
+    dmatrix & operator*=(const dmatrix & a)
+    {
+        check(a);
+        detail::parallel_transform<simd::multiplies>(data(), a.data(), size());
+        return *this;
+    }
+    dmatrix & operator/=(const dmatrix & a)
+    {
+        check(a);
+        detail::parallel_transform<simd::divides>(data(), a.data(), size());
+        return *this;
+    }
+
+private:
+    void check(const dmatrix & a) const
+    {
+        if (a.rows() != rows() || a.cols() != cols())
+            throw std::out_of_range(__func__);
+    }
+
+    size_t n;   //! The number of rows
+    size_t m;   //! The number of columns
+    std::vector<T, detail::default_init_allocator<T> > store;
+};
+
+/** ## Binary operators
+ *
+ * As with `dvector`, temporaries on the left (or on the right for the
+ * commutative operators) are reused for the result.
+ */
+#define VECMAT_DMATRIX_OPERATOR(SYMBOL)                                     \
+template <typename T>                                                       \
+dmatrix<T> operator SYMBOL(dmatrix<T> a, const dmatrix<T> & b)              \
+{                                                                           \
+    a SYMBOL##= b;                                                          \
+    return a;                                                               \
+}                                                                           \
+template <typename T, typename U>                                           \
+typename std::enable_if<is_scalar<U>::value, dmatrix<T> >::type             \
+operator SYMBOL(dmatrix<T> a, const U & b)                                  \
+{                                                                           \
+    a SYMBOL##= static_cast<T>(b);                                          \
+    return a;                                                               \
+}
+
+VECMAT_DMATRIX_OPERATOR(+)
+VECMAT_DMATRIX_OPERATOR(-)
+VECMAT_DMATRIX_OPERATOR(*)
+VECMAT_DMATRIX_OPERATOR(/)
+
+#undef VECMAT_DMATRIX_OPERATOR
+
+template <typename T>
+dmatrix<T> operator+(const dmatrix<T> & a, dmatrix<T> && b)
+{
+    b += a;
+    return std::move(b);
+}
+template <typename T>
+dmatrix<T> operator*(const dmatrix<T> & a, dmatrix<T> && b)
+{
+    b *= a;
+    return std::move(b);
+}
+
+template <typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, dmatrix<T> >::type
+operator+(const U & a, dmatrix<T> b)
+{
+    b += static_cast<T>(a);
+    return b;
+}
+template <typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, dmatrix<T> >::type
+operator-(const U & a, dmatrix<T> b)
+{
+    b = -std::move(b);
+    b += static_cast<T>(a);
+    return b;
+}
+template <typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, dmatrix<T> >::type
+operator*(const U & a, dmatrix<T> b)
+{
+    b *= static_cast<T>(a);
+    return b;
+}
+
+/** ### Comparison operators
+ */
+template <typename T>
+bool operator==(const dmatrix<T> & a, const dmatrix<T> & b)
+{
+    return a.rows() == b.rows() && a.cols() == b.cols() &&
+           std::equal(a.cbegin(), a.cend(), b.cbegin());
+}
+template <typename T>
+bool operator!=(const dmatrix<T> & a, const dmatrix<T> & b)
+{
+    return ! operator==(a, b);
+}
+
+/**
+ * @brief The inner product
+ *
+ * The same three forms as the fixed size matrices.  The matrix-matrix
+ * product goes through `gemm` and the others through `gemv`.  Both
+ * write every element, so the result starts uninitialized.
+ */
+template <typename T>
+dmatrix<T> dot(const dmatrix<T> & a, const dmatrix<T> & b)
+{
+    if (a.cols() != b.rows())
+        throw std::out_of_range(__func__);
+
+    dmatrix<T> c(a.rows(), b.cols(), detail::uninitialized_t());
+    gemm(a.rows(), b.cols(), a.cols(), a.data(), a.rows(),
+         b.data(), b.rows(), c.data(), c.rows());
+    return c;
+}
+
+template <typename T>
+dvector<T> dot(const dmatrix<T> & a, const dvector<T> & b)
+{
+    if (a.cols() != b.size())
+        throw std::out_of_range(__func__);
+
+    dvector<T> c(a.rows(), detail::uninitialized_t());
+    gemv(false, a.rows(), a.cols(), a.data(), a.rows(), b.data(),
+         c.data());
+    return c;
+}
+
+template <typename T>
+dvector<T> dot(const dvector<T> & a, const dmatrix<T> & b)
+{
+    if (a.size() != b.rows())
+        throw std::out_of_range(__func__);
+
+    dvector<T> c(b.cols(), detail::uninitialized_t());
+    gemv(true, b.rows(), b.cols(), b.data(), b.rows(), a.data(),
+         c.data());
+    return c;
+}
+
+/** ## Transpose
+ *
+ * These use the same cache oblivious kernels as the fixed size
+ * matrices.  A square matrix is transposed in place; any other shape
+ * needs a second buffer, which then replaces the original.
+ */
+template <typename T>
+dmatrix<T> transpose_copy(const dmatrix<T> & a)
+{
+    dmatrix<T> b(a.cols(), a.rows());
+    transpose_copy(a.rows(), a.cols(), a.data(), a.rows(),
+                   b.data(), b.rows());
+    return b;
+}
+
+template <typename T>
+dmatrix<T> & transpose_inplace(dmatrix<T> & a)
+{
+    if (a.rows() == a.cols())
+        detail::transpose_square(a.rows(), a.data(), a.rows());
+    else
+        a = transpose_copy(a);
+    return a;
+}
+
+/** ## Stream operators
+ */
+/**
+ * Output the matrix as a comma separated list in column major order
+ */
+template <typename T>
+std::ostream & operator<<(std::ostream & os, const dmatrix<T> & a)
+{
+    if (a.size() == 0)
+        return os;
+
+    os << a[0];
+    for (size_t i = 1; i < a.size(); ++i)
+        os << ", " << a[i];
+
+    return os;
+}
+
+/**
+ * Read the matrix as a potentially comma separated list
+ *
+ * The matrix must already have the expected dimensions.  On error,
+ * this puts the stream back to its initial position and places a quiet
+ * NaN in every element.
+ */
+template <typename T>
+std::istream & operator>>(std::istream & is, dmatrix<T> & a)
+{
+    if (a.size() == 0)
+        return is;
+
+    std::istream::pos_type pos = is.tellg();
+    is >> std::ws >> a[0];
+    for (size_t i = 1; i < a.size(); ++i)
+    {
+        if (!is.good())
+        {
+            is.seekg(pos);
+            a = std::numeric_limits<T>::quiet_NaN();
+            break;
+        }
+        is >> std::ws;
+        char comma = is.get();
+        if (!is.good())
+        {
+            is.seekg(pos);
+            a = std::numeric_limits<T>::quiet_NaN();
+            break;
+        }
+        if (comma != ',')
+            is.unget();
+
+        is >> std::ws >> a[i];
+    }
+    return is;
+}
+
+/** Resize and cast a matrix
+ *
+ * The same zero filling rules as the fixed size `resize_cast` apply.
+ * We can go from dynamic to dynamic, fixed to dynamic, and dynamic to
+ * fixed.  Large dynamic results are filled across the thread pool.
+ */
+template <typename T, typename U>
+dmatrix<T> resize_cast(const dmatrix<U> & a, size_t n, size_t m)
+{
+    dmatrix<T> b(n, m);
+    const size_t rows = std::min(n, a.rows());
+    const size_t cols = std::min(m, a.cols());
+    detail::cast_columns(b.data(), n, a.data(), a.rows(), rows, cols);
+    return b;
+}
+template <typename T, size_t I, size_t J, typename U>
+dmatrix<T> resize_cast(const matrix<I, J, U> & a, size_t n, size_t m)
+{
+    dmatrix<T> b(n, m);
+    const size_t rows = std::min(n, I);
+    const size_t cols = std::min(m, J);
+    detail::cast_columns(b.data(), n, a.data, I, rows, cols);
+    return b;
+}
+template <size_t N, size_t M, typename T, typename U>
+matrix<N, M, T> resize_cast(const dmatrix<U> & a)
+{
+    matrix<N, M, T> b {};
+    const size_t rows = std::min(N, a.rows());
+    const size_t cols = std::min(M, a.cols());
+    for (size_t j = 0; j < cols; ++j)
+        for (size_t i = 0; i < rows; ++i)
+            b.data[i + j * N] = static_cast<T>(a.data()[i + j * a.rows()]);
+
+    return b;
+}
+
+}; // end namespace vecmat
+
+#endif
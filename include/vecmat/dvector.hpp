@@ -0,0 +1,451 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_DVECTOR_H
+#define VECMAT_DVECTOR_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vecmat/aligned.hpp"
+#include "vecmat/bounds.hpp"
+#include "vecmat/parallel.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/vector.hpp"
+
+namespace vecmat {
+
+template <typename T>
+class dvector {
+    /** A vector whose length is chosen at runtime
+     *
+     * This is the counterpart of `vector` for problems that are too big
+     * for the stack or whose size comes from input.  The data live on
+     * the heap in a single 64 byte aligned block, and moving a
+     * `dvector` moves the block instead of copying it.  The binary
+     * operators take advantage of this by reusing the storage of
+     * temporary operands, so chained arithmetic does not allocate past
+     * the first operation.
+     *
+     * Operations between vectors of different lengths throw
+     * std::out_of_range.
+     */
+public:
+    /** ## Type definitions
+     */
+    typedef T        type_t;         //! The base type of the vector
+    typedef T*       iterator;       //! The iterator across the data
+    typedef const T* const_iterator; //! The iterator across the constant data
+
+    /** ## Construction
+     *
+     * A new vector of a given length is filled with zeros unless told
+     * otherwise.  Fixed size vectors convert to dynamic vectors of the
+     * same length.  The fills and copies of large vectors are split
+     * across the thread pool and streamed.  The library's own kernels
+     * may leave a new vector uninitialized when they are about to write
+     * every element.
+     */
+    dvector(void) {}
+    explicit dvector(size_t n, const T & a = T()) : store(n)
+    {
+        detail::parallel_fill(data(), a, n);
+    }
+    dvector(size_t n, detail::uninitialized_t) : store(n) {}
+    dvector(std::initializer_list<T> a) : store(a) {}
+    template <size_t N>
+    dvector(const vector<N, T> & a) : store(a.cbegin(), a.cend()) {}
+    dvector(const dvector & a) : store(a.size())
+    {
+        detail::parallel_cast(data(), a.data(), size());
+    }
+    dvector(dvector &&) = default;
+
+    dvector & operator=(const dvector & a)
+    {
+        if (this == &a)
+            return *this;
+        if (a.size() > store.capacity())
+            store.clear();
+        store.resize(a.size());
+        detail::parallel_cast(data(), a.data(), size());
+        return *this;
+    }
+    dvector & operator=(dvector &&) = default;
+
+    /** ## Size and data
+     */
+    size_t size(void) const
+    {
+        return store.size();
+    }
+    void resize(size_t n, const T & a = T())
+    {
+        store.resize(n, a);
+    }
+    T * data(void)
+    {
+        return store.data();
+    }
+    const T * data(void) const
+    {
+        return store.data();
+    }
+
+    /** ## Iterator access
+     */
+    iterator begin(void)
+    {
+        return data();
+    }
+    iterator end(void)
+    {
+        return data() + size();
+    }
+    const_iterator begin(void) const
+    {
+        return data();
+    }
+    const_iterator end(void) const
+    {
+        return data() + size();
+    }
+    const_iterator cbegin(void) const
+    {
+        return data();
+    }
+    const_iterator cend(void) const
+    {
+        return data() + size();
+    }
+
+    /** ## Access operations
+     *
+     * The index is checked according to `VECMAT_BOUNDS_CHECK`.
+     */
+    const T & operator[](const size_t & i) const
+    {
+        detail::check_bounds(i, size(), __func__);
+        return store[i];
+    }
+    T & operator[](const size_t & i)
+    {
+        detail::check_bounds(i, size(), __func__);
+        return store[i];
+    }
+    const T & operator()(const size_t & i) const
+    {
+        return operator[](i);
+    }
+    T & operator()(const size_t & i)
+    {
+        return operator[](i);
+    }
+
+    /** ## Unary operator
+     *
+     * Negating a temporary negates it in place.
+     */
+    dvector operator-() const &
+    {
+        dvector b(*this);
+        return -std::move(b);
+    }
+    dvector operator-() &&
+    {
+        detail::parallel_broadcast<simd::multiplies>(data(),
+                                                     static_cast<T>(-1),
+                                                     size());
+        return std::move(*this);
+    }
+
+    /** Scalar assignment
+     *
+     * Scalar assignment broadcasts the scalar to every element of the
+     * vector.
+     */
+    dvector & operator=(const T & a)
+    {
+        detail::parallel_fill(data(), a, size());
+        return *this;
+    }
+
+    /** ## Compound assignment
+     */
+    /** ### Scalar compound assignment
+     */
+    dvector & operator+=(const T & a)
+    {
+        detail::parallel_broadcast<simd::plus>(data(), a, size());
+        return *this;
+    }
+    dvector & operator-=(const T & a)
+    {
+        detail::parallel_broadcast<simd::minus>(data(), a, size());
+        return *this;
+    }
+    dvector & operator*=(const T & a)
+    {
+        detail::parallel_broadcast<simd::multiplies>(data(), a, size());
+        return *this;
+    }
+    dvector & operator/=(const T & a)
+    {
+        detail::parallel_broadcast<simd::divides>(data(), a, size());
+        return *this;
+    }
+
+    /** ### Vector compound assignments
+     */
+    dvector & operator+=(const dvector & a)
+    {
+        check(a);
+        detail::parallel_transform<simd::plus>(data(), a.data(), size());
+        return *this;
+    }
+    dvector & operator-=(const dvector & a)
+    {
+        check(a);
+        detail::parallel_transform<simd::minus>(data(), a.data(), size());
+        return *this;
+    }
+    dvector & operator*=(const dvector & a)
+    {
+        check(a);
+        detail::parallel_transform<simd::multiplies>(data(), a.data(), size());
+        return *this;
+    }
+    dvector & operator/=(const dvector & a)
+    {
+        check(a);
+        detail::parallel_transform<simd::divides>(data(), a.data(), size());
+        return *this;
+    }
+
+private:
+    void check(const dvector & a) const
+    {
+        if (a.size() != size())
+            throw std::out_of_range(__func__);
+    }
+
+    std::vector<T, detail::default_init_allocator<T> > store;
+};
+
+/** ## Binary operators
+ *
+ * These follow the fixed size operators.  The left operand is taken by
+ * value so a temporary on the left is moved into the result.  For the
+ * commutative operators, a temporary on the right is reused instead.
+ */
+#define VECMAT_DVECTOR_OPERATOR(SYMBOL)                                     \
+template <typename T>                                                       \
+dvector<T> operator SYMBOL(dvector<T> a, const dvector<T> & b)              \
+{                                                                           \
+    a SYMBOL##= b;                                                          \
+    return a;                                                               \
+}                                                                           \
+template <typename T, typename U>                                           \
+typename std::enable_if<is_scalar<U>::value, dvector<T> >::type             \
+operator SYMBOL(dvector<T> a, const U & b)                                  \
+{                                                                           \
+    a SYMBOL##= static_cast<T>(b);                                          \
+    return a;                                                               \
+}
+
+VECMAT_DVECTOR_OPERATOR(+)
+VECMAT_DVECTOR_OPERATOR(-)
+VECMAT_DVECTOR_OPERATOR(*)
+VECMAT_DVECTOR_OPERATOR(/)
+
+#undef VECMAT_DVECTOR_OPERATOR
+
+template <typename T>
+dvector<T> operator+(const dvector<T> & a, dvector<T> && b)
+{
+    b += a;
+    return std::move(b);
+}
+template <typename T>
+dvector<T> operator*(const dvector<T> & a, dvector<T> && b)
+{
+    b *= a;
+    return std::move(b);
+}
+
+template <typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, dvector<T> >::type
+operator+(const U & a, dvector<T> b)
+{
+    b += static_cast<T>(a);
+    return b;
+}
+template <typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, dvector<T> >::type
+operator-(const U & a, dvector<T> b)
+{
+    b = -std::move(b);
+    b += static_cast<T>(a);
+    return b;
+}
+template <typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, dvector<T> >::type
+operator*(const U & a, dvector<T> b)
+{
+    b *= static_cast<T>(a);
+    return b;
+}
+
+/** ### Comparison operators
+ */
+template <typename T>
+bool operator==(const dvector<T> & a, const dvector<T> & b)
+{
+    return a.size() == b.size() && std::equal(a.cbegin(), a.cend(),
+                                              b.cbegin());
+}
+template <typename T>
+bool operator!=(const dvector<T> & a, const dvector<T> & b)
+{
+    return ! operator==(a, b);
+}
+
+/**
+ * @brief The inner product
+ */
+template <typename T>
+T dot(const dvector<T> & a, const dvector<T> & b)
+{
+    if (a.size() != b.size())
+        throw std::out_of_range(__func__);
+
+    return simd::inner(a.data(), b.data(), a.size());
+}
+
+/** ## Stream operators
+ */
+/**
+ * Output the vector as a comma separated list
+ */
+template <typename T>
+std::ostream & operator<<(std::ostream & os, const dvector<T> & a)
+{
+    if (a.size() == 0)
+        return os;
+
+    os << a[0];
+    for (size_t i = 1; i < a.size(); ++i)
+        os << ", " << a[i];
+
+    return os;
+}
+
+/**
+ * Read the vector as a potentially comma separated list
+ *
+ * The vector must already have the expected length.  Just like the
+ * fixed size vector, on error this puts the stream back to its initial
+ * position and places a quiet NaN in every element.
+ */
+template <typename T>
+std::istream & operator>>(std::istream & is, dvector<T> & a)
+{
+    if (a.size() == 0)
+        return is;
+
+    std::istream::pos_type pos = is.tellg();
+    is >> std::ws >> a[0];
+    for (size_t i = 1; i < a.size(); ++i)
+    {
+        if (!is.good())
+        {
+            is.seekg(pos);
+            a = std::numeric_limits<T>::quiet_NaN();
+            break;
+        }
+        is >> std::ws;
+        char comma = is.get();
+        if (!is.good())
+        {
+            is.seekg(pos);
+            a = std::numeric_limits<T>::quiet_NaN();
+            break;
+        }
+        if (comma != ',')
+            is.unget();
+
+        is >> std::ws >> a[i];
+    }
+    return is;
+}
+
+/** Resize and cast a vector
+ *
+ * The same zero filling rules as the fixed size `resize_cast` apply.
+ * We can go from dynamic to dynamic, fixed to dynamic, and dynamic to
+ * fixed.  Large dynamic results are filled across the thread pool.
+ */
+template <typename T, typename U>
+dvector<T> resize_cast(const dvector<U> & a, size_t n)
+{
+    dvector<T> b(n, detail::uninitialized_t());
+    const size_t m = std::min(n, a.size());
+    detail::parallel_cast(b.data(), a.data(), m);
+    detail::parallel_fill(b.data() + m, T(0), n - m);
+    return b;
+}
+template <typename T, size_t M, typename U>
+dvector<T> resize_cast(const vector<M, U> & a, size_t n)
+{
+    dvector<T> b(n, detail::uninitialized_t());
+    const size_t m = std::min(n, M);
+    detail::parallel_cast(b.data(), a.data, m);
+    detail::parallel_fill(b.data() + m, T(0), n - m);
+    return b;
+}
+template <size_t N, typename T, typename U>
+vector<N, T> resize_cast(const dvector<U> & a)
+{
+    vector<N, T> b {};
+    const size_t m = std::min(N, a.size());
+    std::transform(a.cbegin(), a.cbegin() + m, b.begin(),
+                   [](const U & x) { return static_cast<T>(x); });
+    return b;
+}
+
+}; // end namespace vecmat
+
+#endif
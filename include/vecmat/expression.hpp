@@ -0,0 +1,315 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_EXPRESSION_H
+#define VECMAT_EXPRESSION_H
+
+#include <cstdlib>
+#include <type_traits>
+
+#include "vecmat/matrix.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/vector.hpp"
+
+namespace vecmat {
+
+/** # Expression templates
+ *
+ * The binary operators return a fresh object for every operation, so
+ * `a * s + b * t - c` makes several temporaries and several passes
+ * over memory.  Wrapping operands in `lazy` instead builds a tree of
+ * the operations that is only evaluated, in one fused loop, when it is
+ * assigned to a vector or matrix:
+ *
+ *     vecmat::vector<1024, float> d;
+ *     d = vecmat::lazy(a) * s + vecmat::lazy(b) * t - c;
+ *
+ * An operator joins the tree when either side is already part of it,
+ * so a sub-term with no lazy operand, like `b * t` on its own, is
+ * still evaluated eagerly into a temporary first.
+ *
+ * The tree only holds pointers to the operands, so it must be assigned
+ * (or passed to `eval`) within the statement that created it.
+ */
+
+/** ## Storage traits
+ *
+ * The number of elements of the concrete types an expression can wrap.
+ */
+template <typename V>
+struct storage_traits {
+    static const bool value = false;
+};
+template <size_t N, typename T>
+struct storage_traits<vector<N, T> > {
+    static const bool value = true;
+    static const size_t size = N;
+};
+template <size_t N, size_t M, typename T>
+struct storage_traits<matrix<N, M, T> > {
+    static const bool value = true;
+    static const size_t size = N * M;
+};
+
+/** ## Expression base
+ *
+ * Every node derives from `expression` with itself as the argument.
+ * Nodes provide
+ *
+ * - `result_t` the concrete type the expression evaluates to,
+ * - `type_t` the element type,
+ * - `size` the number of elements,
+ * - `vectorizable` whether the native pack supports every operation,
+ * - `load<P>(i)` the pack of `P::width` results starting at `i`.
+ */
+template <typename E>
+struct expression {
+    const E & self(void) const
+    {
+        return static_cast<const E &>(*this);
+    }
+
+    /** Evaluate every element into `out` in a single pass
+     */
+    template <typename T>
+    void evaluate(T * out) const
+    {
+        typedef typename std::conditional<E::vectorizable,
+                                          simd::pack<T>,
+                                          simd::scalar<T> >::type P;
+        typedef simd::scalar<T> S;
+
+        const E & e = self();
+        size_t i = 0;
+        for (; i + P::width <= E::size; i += P::width)
+            P::storeu(out + i, e.template load<P>(i));
+        for (; i < E::size; ++i)
+            out[i] = e.template load<S>(i);
+    }
+};
+
+/** ### Leaves
+ *
+ * A terminal refers to the data of a vector or matrix and a constant
+ * broadcasts a scalar.
+ */
+template <typename V>
+struct terminal : expression<terminal<V> > {
+    typedef V result_t;
+    typedef typename V::type_t type_t;
+    static const size_t size = storage_traits<V>::size;
+    static const bool vectorizable = true;
+
+    explicit terminal(const V & v) : data(v.data) {}
+
+    template <typename P>
+    typename P::type load(size_t i) const
+    {
+        return P::loadu(data + i);
+    }
+
+    const type_t * data;
+};
+
+template <typename T>
+struct constant {
+    typedef void result_t;
+    static const bool vectorizable = true;
+
+    explicit constant(const T & v) : value(v) {}
+
+    template <typename P>
+    typename P::type load(size_t) const
+    {
+        return P::set1(value);
+    }
+
+    T value;
+};
+
+/** ### Interior nodes
+ */
+/** Constants have no shape of their own, so a binary node takes the
+ * shape of whichever operand is not a constant.
+ */
+template <typename L, typename R, template <typename> class Op>
+struct binary : expression<binary<L, R, Op> > {
+    typedef typename std::conditional<
+        std::is_void<typename L::result_t>::value, R, L>::type shape_t;
+    typedef typename shape_t::result_t result_t;
+    typedef typename shape_t::type_t type_t;
+    static const size_t size = shape_t::size;
+    static const bool vectorizable =
+        L::vectorizable && R::vectorizable &&
+        simd::kernel_pack<Op, type_t>::type::width ==
+        simd::pack<type_t>::width;
+
+    binary(const L & l, const R & r) : lhs(l), rhs(r) {}
+
+    template <typename P>
+    typename P::type load(size_t i) const
+    {
+        return Op<P>::apply(lhs.template load<P>(i),
+                            rhs.template load<P>(i));
+    }
+
+    L lhs;
+    R rhs;
+};
+
+template <typename E>
+struct negate : expression<negate<E> > {
+    typedef typename E::result_t result_t;
+    typedef typename E::type_t type_t;
+    static const size_t size = E::size;
+    static const bool vectorizable = E::vectorizable;
+
+    explicit negate(const E & e) : arg(e) {}
+
+    template <typename P>
+    typename P::type load(size_t i) const
+    {
+        // Multiplying by -1 flips the sign of zero like negation does
+        return P::mul(arg.template load<P>(i),
+                      P::set1(static_cast<type_t>(-1)));
+    }
+
+    E arg;
+};
+
+/** ## Building expressions
+ */
+template <size_t N, typename T>
+terminal<vector<N, T> > lazy(const vector<N, T> & a)
+{
+    return terminal<vector<N, T> >(a);
+}
+template <size_t N, size_t M, typename T>
+terminal<matrix<N, M, T> > lazy(const matrix<N, M, T> & a)
+{
+    return terminal<matrix<N, M, T> >(a);
+}
+
+/** Evaluate an expression into a new object
+ */
+template <typename E>
+typename E::result_t eval(const expression<E> & e)
+{
+    typename E::result_t a;
+    e.self().evaluate(a.data);
+    return a;
+}
+
+template <typename E>
+negate<E> operator-(const expression<E> & a)
+{
+    return negate<E>(a.self());
+}
+
+/** ### Binary operators
+ *
+ * Each operator accepts an expression on either side combined with
+ * another expression, a concrete vector or matrix of the same shape,
+ * or a scalar.  Scalar division by an expression is not provided for
+ * the same reason as with vectors and matrices.
+ */
+#define VECMAT_EXPRESSION_OPERATOR(SYMBOL, OP)                              \
+template <typename L, typename R>                                           \
+binary<L, R, simd::OP> operator SYMBOL(const expression<L> & a,             \
+                                       const expression<R> & b)             \
+{                                                                           \
+    static_assert(std::is_same<typename L::result_t,                        \
+                               typename R::result_t>::value,                \
+                  "expression operands must have the same shape");          \
+    return binary<L, R, simd::OP>(a.self(), b.self());                      \
+}                                                                           \
+template <typename L, typename V>                                           \
+typename std::enable_if<storage_traits<V>::value,                           \
+                        binary<L, terminal<V>, simd::OP> >::type            \
+operator SYMBOL(const expression<L> & a, const V & b)                       \
+{                                                                           \
+    return a SYMBOL lazy(b);                                                \
+}                                                                           \
+template <typename V, typename R>                                           \
+typename std::enable_if<storage_traits<V>::value,                           \
+                        binary<terminal<V>, R, simd::OP> >::type            \
+operator SYMBOL(const V & a, const expression<R> & b)                       \
+{                                                                           \
+    return lazy(a) SYMBOL b;                                                \
+}                                                                           \
+template <typename L, typename U>                                           \
+typename std::enable_if<is_scalar<U>::value,                                \
+    binary<L, constant<typename L::type_t>, simd::OP> >::type               \
+operator SYMBOL(const expression<L> & a, const U & b)                       \
+{                                                                           \
+    typedef constant<typename L::type_t> C;                                 \
+    return binary<L, C, simd::OP>(                                          \
+        a.self(), C(static_cast<typename L::type_t>(b)));                   \
+}
+
+VECMAT_EXPRESSION_OPERATOR(+, plus)
+VECMAT_EXPRESSION_OPERATOR(-, minus)
+VECMAT_EXPRESSION_OPERATOR(*, multiplies)
+VECMAT_EXPRESSION_OPERATOR(/, divides)
+
+#undef VECMAT_EXPRESSION_OPERATOR
+
+/** Scalars on the left
+ */
+template <typename U, typename R>
+typename std::enable_if<is_scalar<U>::value,
+    binary<constant<typename R::type_t>, R, simd::plus> >::type
+operator+(const U & a, const expression<R> & b)
+{
+    typedef constant<typename R::type_t> C;
+    return binary<C, R, simd::plus>(
+        C(static_cast<typename R::type_t>(a)), b.self());
+}
+template <typename U, typename R>
+typename std::enable_if<is_scalar<U>::value,
+    binary<constant<typename R::type_t>, R, simd::minus> >::type
+operator-(const U & a, const expression<R> & b)
+{
+    typedef constant<typename R::type_t> C;
+    return binary<C, R, simd::minus>(
+        C(static_cast<typename R::type_t>(a)), b.self());
+}
+template <typename U, typename R>
+typename std::enable_if<is_scalar<U>::value,
+    binary<constant<typename R::type_t>, R, simd::multiplies> >::type
+operator*(const U & a, const expression<R> & b)
+{
+    typedef constant<typename R::type_t> C;
+    return binary<C, R, simd::multiplies>(
+        C(static_cast<typename R::type_t>(a)), b.self());
+}
+
+}; // end namespace vecmat
+
+#endif
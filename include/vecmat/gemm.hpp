@@ -0,0 +1,352 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_GEMM_H
+#define VECMAT_GEMM_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "vecmat/blas.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/thread_pool.hpp"
+
+namespace vecmat {
+
+namespace detail {
+
+/** ## Blocking parameters
+ *
+ * The product is computed a register tile at a time.  A tile of `MR`
+ * rows by `NR` columns of the output lives entirely in registers while
+ * we stream over `KC` entries of the inner dimension.  The panel of the
+ * left hand side (`MC` by `KC`) is sized to stay in L2 and the panel of
+ * the right hand side (`KC` by `NC`) in L3.
+ */
+template <typename T>
+struct gemm_blocking {
+    typedef simd::pack<T> P;
+
+    static const size_t W = P::width;
+    static const size_t MR = W > 1 ? 2 * W : 4;
+    static const size_t NR = W > 1 ? 6 : 4;
+    static const size_t KC = 256;
+    static const size_t MC = (131072 / (KC * sizeof(T))) / MR * MR > 0
+                           ? (131072 / (KC * sizeof(T))) / MR * MR
+                           : MR;
+    static const size_t NC = 512 * NR;
+
+    /** Products with fewer multiply-adds than this skip the packing */
+    static const size_t threshold = 32 * 32 * 32;
+
+    /** Products with at least this many are split across threads */
+    static const size_t parallel_threshold = 128 * 128 * 128;
+};
+
+template <typename T> const size_t gemm_blocking<T>::W;
+template <typename T> const size_t gemm_blocking<T>::MR;
+template <typename T> const size_t gemm_blocking<T>::NR;
+template <typename T> const size_t gemm_blocking<T>::KC;
+template <typename T> const size_t gemm_blocking<T>::MC;
+template <typename T> const size_t gemm_blocking<T>::NC;
+template <typename T> const size_t gemm_blocking<T>::threshold;
+template <typename T> const size_t gemm_blocking<T>::parallel_threshold;
+
+/** ## Packing
+ *
+ * Copy an `mc` by `kc` block of the left hand side into micro-panels of
+ * `MR` rows stored one column after another.  Rows past `mc` are zero
+ * so the micro-kernel never needs to check the edges.  The operands
+ * are addressed through a row stride and a column stride, so a
+ * transposed operand is packed straight from its untransposed storage.
+ */
+template <typename T>
+void pack_a(size_t mc, size_t kc, const T * a, size_t rsa, size_t csa,
+            T * buf)
+{
+    typedef gemm_blocking<T> B;
+    for (size_t i = 0; i < mc; i += B::MR)
+    {
+        const size_t mr = std::min(B::MR, mc - i);
+        for (size_t k = 0; k < kc; ++k)
+        {
+            const T * src = a + i * rsa + k * csa;
+            for (size_t r = 0; r < mr; ++r)
+                *buf++ = src[r * rsa];
+            for (size_t r = mr; r < B::MR; ++r)
+                *buf++ = static_cast<T>(0);
+        }
+    }
+}
+
+/** Copy a `kc` by `nc` block of the right hand side into micro-panels
+ * of `NR` columns stored one row after another.
+ */
+template <typename T>
+void pack_b(size_t kc, size_t nc, const T * b, size_t rsb, size_t csb,
+            T * buf)
+{
+    typedef gemm_blocking<T> B;
+    for (size_t j = 0; j < nc; j += B::NR)
+    {
+        const size_t nr = std::min(B::NR, nc - j);
+        for (size_t k = 0; k < kc; ++k)
+        {
+            for (size_t r = 0; r < nr; ++r)
+                *buf++ = b[k * rsb + (j + r) * csb];
+            for (size_t r = nr; r < B::NR; ++r)
+                *buf++ = static_cast<T>(0);
+        }
+    }
+}
+
+/** ## Micro-kernel
+ *
+ * Accumulate the product of an `MR` by `kc` packed panel and a `kc` by
+ * `NR` packed panel into the `mr` by `nr` corner of `c`.
+ */
+template <typename T>
+void micro_kernel(size_t kc, const T * a, const T * b, T * c, size_t ldc,
+                  size_t mr, size_t nr)
+{
+    typedef gemm_blocking<T> B;
+    typedef typename B::P P;
+    static const size_t MP = B::MR / B::W;
+
+    typename P::type acc[B::NR][MP];
+    for (size_t j = 0; j < B::NR; ++j)
+        for (size_t r = 0; r < MP; ++r)
+            acc[j][r] = P::set1(static_cast<T>(0));
+
+    for (size_t k = 0; k < kc; ++k, a += B::MR, b += B::NR)
+    {
+        typename P::type ak[MP];
+        for (size_t r = 0; r < MP; ++r)
+            ak[r] = P::loadu(a + r * B::W);
+        for (size_t j = 0; j < B::NR; ++j)
+        {
+            const typename P::type bj = P::set1(b[j]);
+            for (size_t r = 0; r < MP; ++r)
+                acc[j][r] = P::fmadd(ak[r], bj, acc[j][r]);
+        }
+    }
+
+    if (mr == B::MR && nr == B::NR)
+    {
+        for (size_t j = 0; j < B::NR; ++j)
+            for (size_t r = 0; r < MP; ++r)
+            {
+                T * p = c + r * B::W + j * ldc;
+                P::storeu(p, P::add(P::loadu(p), acc[j][r]));
+            }
+    }
+    else
+    {
+        T tmp[B::MR * B::NR];
+        for (size_t j = 0; j < B::NR; ++j)
+            for (size_t r = 0; r < MP; ++r)
+                P::storeu(tmp + r * B::W + j * B::MR, acc[j][r]);
+        for (size_t j = 0; j < nr; ++j)
+            for (size_t i = 0; i < mr; ++i)
+                c[i + j * ldc] += tmp[i + j * B::MR];
+    }
+}
+
+/** ## Blocked product
+ *
+ * Accumulate `c += a b` over the full cache blocking.
+ */
+template <typename T>
+void gemm_blocked(size_t m, size_t n, size_t k,
+                  const T * a, size_t rsa, size_t csa,
+                  const T * b, size_t rsb, size_t csb,
+                  T * c, size_t ldc)
+{
+    typedef gemm_blocking<T> B;
+    std::vector<T> abuf(B::MC * B::KC);
+    std::vector<T> bbuf(B::KC * ((std::min(B::NC, n) + B::NR - 1) / B::NR
+                                 * B::NR));
+
+    for (size_t jc = 0; jc < n; jc += B::NC)
+    {
+        const size_t nc = std::min(B::NC, n - jc);
+        for (size_t pc = 0; pc < k; pc += B::KC)
+        {
+            const size_t kc = std::min(B::KC, k - pc);
+            pack_b(kc, nc, b + pc * rsb + jc * csb, rsb, csb,
+                   bbuf.data());
+            for (size_t ic = 0; ic < m; ic += B::MC)
+            {
+                const size_t mc = std::min(B::MC, m - ic);
+                pack_a(mc, kc, a + ic * rsa + pc * csa, rsa, csa,
+                       abuf.data());
+                for (size_t jr = 0; jr < nc; jr += B::NR)
+                    for (size_t ir = 0; ir < mc; ir += B::MR)
+                        micro_kernel(kc,
+                                     abuf.data() + ir * kc,
+                                     bbuf.data() + jr * kc,
+                                     c + ic + ir + (jc + jr) * ldc, ldc,
+                                     std::min(B::MR, mc - ir),
+                                     std::min(B::NR, nc - jr));
+            }
+        }
+    }
+}
+
+/** ## Parallel product
+ *
+ * Partition the output into tiles of `MC` rows by a multiple of `NR`
+ * columns and hand the tiles to the thread pool.  Each tile runs the
+ * full blocked product with its own packing buffers, so the threads
+ * never write to the same part of `c`.  We aim for a couple of tiles
+ * per thread so uneven tiles still balance.
+ */
+template <typename T>
+void gemm_parallel(size_t m, size_t n, size_t k,
+                   const T * a, size_t rsa, size_t csa,
+                   const T * b, size_t rsb, size_t csb,
+                   T * c, size_t ldc)
+{
+    typedef gemm_blocking<T> B;
+    const size_t rows = (m + B::MC - 1) / B::MC;
+    const size_t want = 2 * num_threads();
+    const size_t split = std::max<size_t>(1, (want + rows - 1) / rows);
+    const size_t nb = ((n + split - 1) / split + B::NR - 1) / B::NR * B::NR;
+    const size_t cols = (n + nb - 1) / nb;
+
+    parallel_for(rows * cols, [=](size_t t) {
+        const size_t i0 = (t % rows) * B::MC;
+        const size_t j0 = (t / rows) * nb;
+        gemm_blocked(std::min(B::MC, m - i0), std::min(nb, n - j0), k,
+                     a + i0 * rsa, rsa, csa,
+                     b + j0 * csb, rsb, csb,
+                     c + i0 + j0 * ldc, ldc);
+    });
+}
+
+/** ## Small product
+ *
+ * Without packing, the best we can do is walk `a` along whichever
+ * direction is contiguous.  Normally each column of `c` accumulates the
+ * columns of `a` scaled by the entries of the matching column of `b`.
+ * When `a` is transposed its rows are contiguous instead, so each entry
+ * of `c` is the inner product of a row of `a` with a column of `b`.
+ */
+template <typename T>
+void gemm_small(size_t m, size_t n, size_t k,
+                const T * a, size_t rsa, size_t csa,
+                const T * b, size_t rsb, size_t csb,
+                T * c, size_t ldc)
+{
+    if (rsa == 1)
+    {
+        for (size_t j = 0; j < n; ++j)
+            for (size_t p = 0; p < k; ++p)
+            {
+                const T bpj = b[p * rsb + j * csb];
+                const T * ap = a + p * csa;
+                T * cj = c + j * ldc;
+                for (size_t i = 0; i < m; ++i)
+                    cj[i] += ap[i] * bpj;
+            }
+    }
+    else
+    {
+        for (size_t j = 0; j < n; ++j)
+            for (size_t i = 0; i < m; ++i)
+            {
+                const T * ai = a + i * rsa;
+                const T * bj = b + j * csb;
+                T cij = static_cast<T>(0);
+                for (size_t p = 0; p < k; ++p)
+                    cij += ai[p * csa] * bj[p * rsb];
+                c[i + j * ldc] += cij;
+            }
+    }
+}
+
+}; // end namespace detail
+
+/**
+ * @brief General matrix-matrix product
+ *
+ * Compute `c = op(a) op(b)` where `op(a)` is `m` by `k`, `op(b)` is `k`
+ * by `n`, and `c` is `m` by `n`.  `op(x)` is `x` itself or, when the
+ * matching flag is set, its transpose.  As in the BLAS, the leading
+ * dimensions describe the column-major storage of `a` and `b` before
+ * the transpose.  The transposes are never formed; the packing reads
+ * the operands in their original layout.  The output must not alias
+ * either input.  Large products are spread across the thread pool when
+ * it has more than one thread, or handed to the BLAS when built with
+ * `VECMAT_USE_BLAS`.
+ */
+template <typename T>
+void gemm(bool transa, bool transb,
+          size_t m, size_t n, size_t k,
+          const T * a, size_t lda,
+          const T * b, size_t ldb,
+          T * c, size_t ldc)
+{
+#if defined(VECMAT_USE_BLAS)
+    if (detail::blas_gemm(transa, transb, m, n, k, a, lda, b, ldb, c, ldc))
+        return;
+#endif
+    for (size_t j = 0; j < n; ++j)
+        std::fill(c + j * ldc, c + j * ldc + m, static_cast<T>(0));
+
+    const size_t rsa = transa ? lda : 1;
+    const size_t csa = transa ? 1 : lda;
+    const size_t rsb = transb ? ldb : 1;
+    const size_t csb = transb ? 1 : ldb;
+
+    typedef detail::gemm_blocking<T> B;
+    const size_t size = m * n * k;
+    if (size < B::threshold)
+        detail::gemm_small(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+    else if (size >= B::parallel_threshold && num_threads() > 1)
+        detail::gemm_parallel(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+    else
+        detail::gemm_blocked(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+}
+
+/** Compute `c = a b` without transposes
+ */
+template <typename T>
+void gemm(size_t m, size_t n, size_t k,
+          const T * a, size_t lda,
+          const T * b, size_t ldb,
+          T * c, size_t ldc)
+{
+    gemm(false, false, m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+}; // end namespace vecmat
+
+#endif
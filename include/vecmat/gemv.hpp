@@ -0,0 +1,246 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_GEMV_H
+#define VECMAT_GEMV_H
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "vecmat/blas.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/thread_pool.hpp"
+
+namespace vecmat {
+
+namespace detail {
+
+/** ## Matrix-vector kernels
+ *
+ * A matrix-vector product touches every element of the matrix exactly
+ * once, so it runs at the speed the matrix streams in from memory.
+ * Both kernels therefore walk down the contiguous columns and handle
+ * four columns per pass, which keeps four independent multiply-add
+ * chains in flight and quarters the traffic on the other operand.
+ */
+/** Products with at least this many elements are split across threads */
+static const size_t gemv_parallel_threshold = 512 * 512;
+
+/** Accumulate `y += a x` where `a` is `m` by `n`
+ *
+ * Each pass adds four columns of `a`, scaled by the matching entries
+ * of `x`, into `y`.
+ */
+template <typename T>
+void gemv_n(size_t m, size_t n, const T * a, size_t lda,
+            const T * x, T * y)
+{
+    typedef simd::pack<T> P;
+    const size_t mp = m - m % P::width;
+    const size_t n4 = n - n % 4;
+    size_t j = 0;
+    for (; j < n4; j += 4)
+    {
+        const T * a0 = a + j * lda;
+        const T * a1 = a0 + lda;
+        const T * a2 = a1 + lda;
+        const T * a3 = a2 + lda;
+        const typename P::type x0 = P::set1(x[j]);
+        const typename P::type x1 = P::set1(x[j + 1]);
+        const typename P::type x2 = P::set1(x[j + 2]);
+        const typename P::type x3 = P::set1(x[j + 3]);
+        size_t i = 0;
+        for (; i < mp; i += P::width)
+        {
+            typename P::type r = P::loadu(y + i);
+            r = P::fmadd(P::loadu(a0 + i), x0, r);
+            r = P::fmadd(P::loadu(a1 + i), x1, r);
+            r = P::fmadd(P::loadu(a2 + i), x2, r);
+            r = P::fmadd(P::loadu(a3 + i), x3, r);
+            P::storeu(y + i, r);
+        }
+        for (; i < m; ++i)
+            y[i] += a0[i] * x[j] + a1[i] * x[j + 1] +
+                    a2[i] * x[j + 2] + a3[i] * x[j + 3];
+    }
+    for (; j < n; ++j)
+    {
+        const T * aj = a + j * lda;
+        const typename P::type xj = P::set1(x[j]);
+        size_t i = 0;
+        for (; i < mp; i += P::width)
+            P::storeu(y + i, P::fmadd(P::loadu(aj + i), xj,
+                                      P::loadu(y + i)));
+        for (; i < m; ++i)
+            y[i] += aj[i] * x[j];
+    }
+}
+
+/** Sum the elements of a pack
+ */
+template <typename P>
+typename P::value_type hsum(typename P::type a)
+{
+    typename P::value_type tmp[P::width];
+    P::storeu(tmp, a);
+    typename P::value_type ret = tmp[0];
+    for (size_t i = 1; i < P::width; ++i)
+        ret += tmp[i];
+    return ret;
+}
+
+/** Compute `y = a' x` where `a` is `m` by `n`
+ *
+ * Each pass forms the inner products of four columns of `a` with `x`
+ * in separate accumulators, loading each block of `x` once.
+ */
+template <typename T>
+void gemv_t(size_t m, size_t n, const T * a, size_t lda,
+            const T * x, T * y)
+{
+    typedef simd::pack<T> P;
+    const size_t mp = m - m % P::width;
+    const size_t n4 = n - n % 4;
+    size_t j = 0;
+    for (; j < n4; j += 4)
+    {
+        const T * a0 = a + j * lda;
+        const T * a1 = a0 + lda;
+        const T * a2 = a1 + lda;
+        const T * a3 = a2 + lda;
+        typename P::type r0 = P::set1(static_cast<T>(0));
+        typename P::type r1 = r0;
+        typename P::type r2 = r0;
+        typename P::type r3 = r0;
+        size_t i = 0;
+        for (; i < mp; i += P::width)
+        {
+            const typename P::type xi = P::loadu(x + i);
+            r0 = P::fmadd(P::loadu(a0 + i), xi, r0);
+            r1 = P::fmadd(P::loadu(a1 + i), xi, r1);
+            r2 = P::fmadd(P::loadu(a2 + i), xi, r2);
+            r3 = P::fmadd(P::loadu(a3 + i), xi, r3);
+        }
+        T y0 = hsum<P>(r0);
+        T y1 = hsum<P>(r1);
+        T y2 = hsum<P>(r2);
+        T y3 = hsum<P>(r3);
+        for (; i < m; ++i)
+        {
+            y0 += a0[i] * x[i];
+            y1 += a1[i] * x[i];
+            y2 += a2[i] * x[i];
+            y3 += a3[i] * x[i];
+        }
+        y[j] = y0;
+        y[j + 1] = y1;
+        y[j + 2] = y2;
+        y[j + 3] = y3;
+    }
+    for (; j < n; ++j)
+    {
+        const T * aj = a + j * lda;
+        typename P::type r = P::set1(static_cast<T>(0));
+        size_t i = 0;
+        for (; i < mp; i += P::width)
+            r = P::fmadd(P::loadu(aj + i), P::loadu(x + i), r);
+        T yj = hsum<P>(r);
+        for (; i < m; ++i)
+            yj += aj[i] * x[i];
+        y[j] = yj;
+    }
+}
+
+}; // end namespace detail
+
+/**
+ * @brief General matrix-vector product
+ *
+ * With `trans` false compute `y = a x`, where `a` is the `m` by `n`
+ * column-major array with leading dimension `lda`, `x` has `n` entries
+ * and `y` has `m`.  With `trans` set compute `y = a' x` instead, where
+ * `x` has `m` entries and `y` has `n`.  As in `gemm` the dimensions
+ * describe the storage, not the transpose.  The vectors are contiguous
+ * and `y` must not alias the inputs.
+ *
+ * Large products are spread across the thread pool.  The plain product
+ * gives each thread a block of rows and the transposed product a block
+ * of columns, so the threads never write to the same part of `y`.
+ * With `VECMAT_USE_BLAS` large products go to the BLAS instead.
+ */
+template <typename T>
+void gemv(bool trans, size_t m, size_t n, const T * a, size_t lda,
+          const T * x, T * y)
+{
+#if defined(VECMAT_USE_BLAS)
+    if (detail::blas_gemv(trans, m, n, a, lda, x, y))
+        return;
+#endif
+    const bool parallel = m * n >= detail::gemv_parallel_threshold
+                       && num_threads() > 1;
+    if (!trans)
+    {
+        std::fill(y, y + m, static_cast<T>(0));
+        if (!parallel)
+        {
+            detail::gemv_n(m, n, a, lda, x, y);
+            return;
+        }
+
+        // Whole cache lines of y per thread
+        const size_t line = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+        const size_t rows = ((m + num_threads() - 1) / num_threads()
+                             + line - 1) / line * line;
+        parallel_for((m + rows - 1) / rows, [=](size_t t) {
+            const size_t i0 = t * rows;
+            detail::gemv_n(std::min(rows, m - i0), n, a + i0, lda, x,
+                           y + i0);
+        });
+    }
+    else
+    {
+        if (!parallel)
+        {
+            detail::gemv_t(m, n, a, lda, x, y);
+            return;
+        }
+
+        const size_t cols = ((n + num_threads() - 1) / num_threads()
+                             + 3) / 4 * 4;
+        parallel_for((n + cols - 1) / cols, [=](size_t t) {
+            const size_t j0 = t * cols;
+            detail::gemv_t(m, std::min(cols, n - j0), a + j0 * lda, lda,
+                           x, y + j0);
+        });
+    }
+}
+
+}; // end namespace vecmat
+
+#endif
@@ -0,0 +1,708 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_MAP_H
+#define VECMAT_MAP_H
+
+#include <cstdlib>
+#include <iostream>
+#include <type_traits>
+
+#include "vecmat/gemm.hpp"
+#include "vecmat/gemv.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/vector.hpp"
+
+namespace vecmat {
+
+template <size_t N, typename T>
+struct vector_ref {
+    /** A vector over memory we do not own
+     *
+     * Data that already live elsewhere (a mapped buffer object, a
+     * memory mapped file, or another library's array) can be used
+     * directly without copying them into a `vector`.  The elements are
+     * `inc` apart, which defaults to contiguous.  Use `vector_ref<N,
+     * const T>` for read-only data.
+     *
+     * Copying a `vector_ref` copies the view, but assigning to one
+     * writes through to the elements just like a reference.  The
+     * compound assignments work in place and the binary operators
+     * return a new `vector`.  No bounds checking is done.
+     */
+    typedef typename std::remove_const<T>::type type_t;
+    typedef typename std::conditional<std::is_const<T>::value,
+                                      const vector<N, type_t>,
+                                      vector<N, type_t> >::type owner_t;
+
+    T * ptr;        //! The first element
+    size_t inc;     //! The distance between elements
+
+    /** ## Construction
+     */
+    explicit vector_ref(T * p, size_t stride = 1) : ptr(p), inc(stride) {}
+    vector_ref(owner_t & a) : ptr(a.data), inc(1) {}
+    vector_ref(const vector_ref &) = default;
+    template <typename U>
+    vector_ref(const vector_ref<N, U> & a) : ptr(a.ptr), inc(a.inc) {}
+
+    /** ## Access operations
+     */
+    T & operator[](const size_t & i) const
+    {
+        return ptr[i * inc];
+    }
+    T & operator()(const size_t & i) const
+    {
+        return ptr[i * inc];
+    }
+
+    /** Copy the elements into a new vector
+     */
+    operator vector<N, type_t>() const
+    {
+        vector<N, type_t> a;
+        for (size_t i = 0; i < N; ++i)
+            a.data[i] = ptr[i * inc];
+        return a;
+    }
+
+    /** ## Assignment
+     *
+     * Assignment writes through to the referenced elements.  A scalar
+     * broadcasts to every element.
+     */
+    vector_ref & operator=(const vector_ref & a)
+    {
+        return assign<simd::plus>(a, true);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, vector_ref &>::type
+    operator=(const V & a)
+    {
+        return assign<simd::plus>(vector_ref<N, const type_t>(a), true);
+    }
+    vector_ref & operator=(const type_t & a)
+    {
+        for (size_t i = 0; i < N; ++i)
+            ptr[i * inc] = a;
+        return *this;
+    }
+
+    /** ## Compound assignment
+     */
+    vector_ref & operator+=(const type_t & a)
+    {
+        return broadcast<simd::plus>(a);
+    }
+    vector_ref & operator-=(const type_t & a)
+    {
+        return broadcast<simd::minus>(a);
+    }
+    vector_ref & operator*=(const type_t & a)
+    {
+        return broadcast<simd::multiplies>(a);
+    }
+    vector_ref & operator/=(const type_t & a)
+    {
+        return broadcast<simd::divides>(a);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, vector_ref &>::type
+    operator+=(const V & a)
+    {
+        return assign<simd::plus>(vector_ref<N, const type_t>(a), false);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, vector_ref &>::type
+    operator-=(const V & a)
+    {
+        return assign<simd::minus>(vector_ref<N, const type_t>(a), false);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, vector_ref &>::type
+    operator*=(const V & a)
+    {
+        return assign<simd::multiplies>(vector_ref<N, const type_t>(a),
+                                        false);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, vector_ref &>::type
+    operator/=(const V & a)
+    {
+        return assign<simd::divides>(vector_ref<N, const type_t>(a),
+                                     false);
+    }
+
+private:
+    /** Apply the operation element-wise, or copy if `copy` is set.
+     * Contiguous data go through the SIMD kernels.
+     */
+    template <template <typename> class Op, typename U>
+    vector_ref & assign(const vector_ref<N, U> & a, bool copy)
+    {
+        typedef simd::scalar<type_t> S;
+        if (copy)
+            for (size_t i = 0; i < N; ++i)
+                ptr[i * inc] = a.ptr[i * a.inc];
+        else if (inc == 1 && a.inc == 1)
+            simd::transform<Op>(ptr, a.ptr, N);
+        else
+            for (size_t i = 0; i < N; ++i)
+                ptr[i * inc] = Op<S>::apply(ptr[i * inc], a.ptr[i * a.inc]);
+        return *this;
+    }
+    template <template <typename> class Op>
+    vector_ref & broadcast(const type_t & a)
+    {
+        typedef simd::scalar<type_t> S;
+        if (inc == 1)
+            simd::broadcast<Op>(ptr, a, N);
+        else
+            for (size_t i = 0; i < N; ++i)
+                ptr[i * inc] = Op<S>::apply(ptr[i * inc], a);
+        return *this;
+    }
+};
+
+template <size_t N, size_t M, typename T>
+struct matrix_map {
+    /** A matrix over memory we do not own
+     *
+     * The columns are `ld` elements apart, which defaults to tightly
+     * packed.  A larger leading dimension addresses a block of a larger
+     * column-major array, just like the BLAS.  Copying and assignment
+     * follow `vector_ref`.  No bounds checking is done.
+     */
+    typedef typename std::remove_const<T>::type type_t;
+    typedef typename std::conditional<std::is_const<T>::value,
+                                      const matrix<N, M, type_t>,
+                                      matrix<N, M, type_t> >::type owner_t;
+
+    T * ptr;        //! The first element
+    size_t ld;      //! The distance between columns
+
+    /** ## Construction
+     */
+    explicit matrix_map(T * p, size_t lead = N) : ptr(p), ld(lead) {}
+    matrix_map(owner_t & a) : ptr(a.data), ld(N) {}
+    matrix_map(const matrix_map &) = default;
+    template <typename U>
+    matrix_map(const matrix_map<N, M, U> & a) : ptr(a.ptr), ld(a.ld) {}
+
+    /** ## Access operations
+     *
+     * The `[k]` operator uses the column-major index of a tightly
+     * packed matrix regardless of the leading dimension.
+     */
+    T & operator[](const size_t & k) const
+    {
+        return ptr[k % N + (k / N) * ld];
+    }
+    T & operator()(const size_t & i, const size_t & j) const
+    {
+        return ptr[i + j * ld];
+    }
+
+    /** Copy the elements into a new matrix
+     */
+    operator matrix<N, M, type_t>() const
+    {
+        matrix<N, M, type_t> a;
+        for (size_t j = 0; j < M; ++j)
+            for (size_t i = 0; i < N; ++i)
+                a.data[i + j * N] = ptr[i + j * ld];
+        return a;
+    }
+
+    /** ## Assignment
+     */
+    matrix_map & operator=(const matrix_map & a)
+    {
+        return assign<simd::plus>(a, true);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, matrix_map &>::type
+    operator=(const V & a)
+    {
+        return assign<simd::plus>(matrix_map<N, M, const type_t>(a), true);
+    }
+    matrix_map & operator=(const type_t & a)
+    {
+        for (size_t j = 0; j < M; ++j)
+            for (size_t i = 0; i < N; ++i)
+                ptr[i + j * ld] = a;
+        return *this;
+    }
+
+    /** ## Compound assignment
+     */
+    matrix_map & operator+=(const type_t & a)
+    {
+        return broadcast<simd::plus>(a);
+    }
+    matrix_map & operator-=(const type_t & a)
+    {
+        return broadcast<simd::minus>(a);
+    }
+    matrix_map & operator*=(const type_t & a)
+    {
+        return broadcast<simd::multiplies>(a);
+    }
+    matrix_map & operator/=(const type_t & a)
+    {
+        return broadcast<simd::divides>(a);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, matrix_map &>::type
+    operator+=(const V & a)
+    {
+        return assign<simd::plus>(matrix_map<N, M, const type_t>(a), false);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, matrix_map &>::type
+    operator-=(const V & a)
+    {
+        return assign<simd::minus>(matrix_map<N, M, const type_t>(a),
+                                   false);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, matrix_map &>::type
+    operator*=(const V & a)
+    {
+        return assign<simd::multiplies>(matrix_map<N, M, const type_t>(a),
+                                        false);
+    }
+    template <typename V>
+    typename std::enable_if<!is_scalar<V>::value, matrix_map &>::type
+    operator/=(const V & a)
+    {
+        return assign<simd::divides>(matrix_map<N, M, const type_t>(a),
+                                     false);
+    }
+
+private:
+    /** Work a column at a time since the columns are contiguous
+     */
+    template <template <typename> class Op, typename U>
+    matrix_map & assign(const matrix_map<N, M, U> & a, bool copy)
+    {
+        for (size_t j = 0; j < M; ++j)
+            if (copy)
+                std::copy(a.ptr + j * a.ld, a.ptr + j * a.ld + N,
+                          ptr + j * ld);
+            else
+                simd::transform<Op>(ptr + j * ld, a.ptr + j * a.ld, N);
+        return *this;
+    }
+    template <template <typename> class Op>
+    matrix_map & broadcast(const type_t & a)
+    {
+        for (size_t j = 0; j < M; ++j)
+            simd::broadcast<Op>(ptr + j * ld, a, N);
+        return *this;
+    }
+};
+
+/** ## Construction helpers
+ *
+ * `map<N>(p)` views `N` elements at `p` as a vector and `map<N, M>(p)`
+ * views them as a matrix.
+ */
+template <size_t N, typename T>
+vector_ref<N, T> map(T * p, size_t inc = 1)
+{
+    return vector_ref<N, T>(p, inc);
+}
+template <size_t N, size_t M, typename T>
+matrix_map<N, M, T> map(T * p, size_t ld = N)
+{
+    return matrix_map<N, M, T>(p, ld);
+}
+
+/** ## Traits
+ *
+ * The free functions below accept any mix of owning and non-owning
+ * operands.  These describe the operands uniformly.
+ */
+template <typename V>
+struct vector_traits {
+    static const bool value = false;
+    static const bool view = false;
+    static const size_t size = 0;
+    typedef void type_t;
+};
+template <size_t N, typename T>
+struct vector_traits<vector<N, T> > {
+    static const bool value = true;
+    static const bool view = false;
+    static const size_t size = N;
+    typedef T type_t;
+    static const T * pointer(const vector<N, T> & a) { return a.data; }
+    static size_t inc(const vector<N, T> &) { return 1; }
+};
+template <size_t N, typename T>
+struct vector_traits<vector_ref<N, T> > {
+    static const bool value = true;
+    static const bool view = true;
+    static const size_t size = N;
+    typedef typename std::remove_const<T>::type type_t;
+    static const type_t * pointer(const vector_ref<N, T> & a)
+    {
+        return a.ptr;
+    }
+    static size_t inc(const vector_ref<N, T> & a) { return a.inc; }
+};
+
+template <typename V>
+struct matrix_traits {
+    static const bool value = false;
+    static const bool view = false;
+    static const bool trans = false;
+    static const size_t rows = 0;
+    static const size_t cols = 0;
+    typedef void type_t;
+};
+template <size_t N, size_t M, typename T>
+struct matrix_traits<matrix<N, M, T> > {
+    static const bool value = true;
+    static const bool view = false;
+    static const bool trans = false;
+    static const size_t rows = N;
+    static const size_t cols = M;
+    typedef T type_t;
+    static const T * pointer(const matrix<N, M, T> & a) { return a.data; }
+    static size_t ld(const matrix<N, M, T> &) { return N; }
+};
+template <size_t N, size_t M, typename T>
+struct matrix_traits<matrix_map<N, M, T> > {
+    static const bool value = true;
+    static const bool view = true;
+    static const bool trans = false;
+    static const size_t rows = N;
+    static const size_t cols = M;
+    typedef typename std::remove_const<T>::type type_t;
+    static const type_t * pointer(const matrix_map<N, M, T> & a)
+    {
+        return a.ptr;
+    }
+    static size_t ld(const matrix_map<N, M, T> & a) { return a.ld; }
+};
+
+/** Pairs of operands where at least one is a view.  Pairs of owning
+ * types are handled by the overloads in `vector.hpp` and `matrix.hpp`.
+ */
+template <typename A, typename B>
+struct vector_view_pair {
+    typedef vector_traits<A> TA;
+    typedef vector_traits<B> TB;
+    static const bool value = TA::value && TB::value &&
+                              (TA::view || TB::view) &&
+                              TA::size == TB::size &&
+                              std::is_same<typename TA::type_t,
+                                           typename TB::type_t>::value;
+    typedef vector<TA::size, typename TA::type_t> result_t;
+};
+template <typename A, typename B>
+struct matrix_view_pair {
+    typedef matrix_traits<A> TA;
+    typedef matrix_traits<B> TB;
+    static const bool value = TA::value && TB::value &&
+                              (TA::view || TB::view) &&
+                              TA::rows == TB::rows &&
+                              TA::cols == TB::cols &&
+                              std::is_same<typename TA::type_t,
+                                           typename TB::type_t>::value;
+    typedef matrix<TA::rows, TA::cols, typename TA::type_t> result_t;
+};
+
+/** A matrix view with a scalar
+ */
+template <typename A, typename U>
+struct matrix_view_scalar {
+    typedef matrix_traits<A> TA;
+    static const bool value = TA::view && is_scalar<U>::value;
+    typedef matrix<TA::rows, TA::cols, typename TA::type_t> result_t;
+};
+
+/** ## Binary operators
+ *
+ * These behave exactly like the operators on the owning types and
+ * return a new `vector` or `matrix`.
+ */
+#define VECMAT_VIEW_OPERATOR(SYMBOL)                                        \
+template <typename A, typename B>                                           \
+typename std::enable_if<vector_view_pair<A, B>::value,                      \
+                        typename vector_view_pair<A, B>::result_t>::type    \
+operator SYMBOL(const A & a, const B & b)                                   \
+{                                                                           \
+    typename vector_view_pair<A, B>::result_t c;                            \
+    for (size_t i = 0; i < vector_traits<A>::size; ++i)                     \
+        c.data[i] = a[i] SYMBOL b[i];                                       \
+    return c;                                                               \
+}                                                                           \
+template <typename A, typename B>                                           \
+typename std::enable_if<matrix_view_pair<A, B>::value,                      \
+                        typename matrix_view_pair<A, B>::result_t>::type    \
+operator SYMBOL(const A & a, const B & b)                                   \
+{                                                                           \
+    typename matrix_view_pair<A, B>::result_t c;                            \
+    for (size_t j = 0, k = 0; j < matrix_traits<A>::cols; ++j)              \
+        for (size_t i = 0; i < matrix_traits<A>::rows; ++i, ++k)            \
+            c.data[k] = a(i, j) SYMBOL b(i, j);                             \
+    return c;                                                               \
+}                                                                           \
+template <size_t N, typename T, typename U>                                 \
+typename std::enable_if<is_scalar<U>::value,                                \
+    vector<N, typename vector_ref<N, T>::type_t> >::type                    \
+operator SYMBOL(const vector_ref<N, T> & a, const U & b)                    \
+{                                                                           \
+    vector<N, typename vector_ref<N, T>::type_t> c = a;                     \
+    return c SYMBOL##= static_cast<typename vector_ref<N, T>::type_t>(b);   \
+}                                                                           \
+template <typename A, typename U>                                           \
+typename std::enable_if<matrix_view_scalar<A, U>::value,                    \
+                        typename matrix_view_scalar<A, U>::result_t>::type  \
+operator SYMBOL(const A & a, const U & b)                                   \
+{                                                                           \
+    typename matrix_view_scalar<A, U>::result_t c = a;                      \
+    return c SYMBOL##= static_cast<typename matrix_traits<A>::type_t>(b);   \
+}
+
+VECMAT_VIEW_OPERATOR(+)
+VECMAT_VIEW_OPERATOR(-)
+VECMAT_VIEW_OPERATOR(*)
+VECMAT_VIEW_OPERATOR(/)
+
+#undef VECMAT_VIEW_OPERATOR
+
+/** Scalars on the left broadcast through the owning operators
+ */
+#define VECMAT_VIEW_SCALAR_OPERATOR(SYMBOL)                                 \
+template <size_t N, typename T, typename U>                                 \
+typename std::enable_if<is_scalar<U>::value,                                \
+    vector<N, typename vector_ref<N, T>::type_t> >::type                    \
+operator SYMBOL(const U & a, const vector_ref<N, T> & b)                    \
+{                                                                           \
+    return a SYMBOL vector<N, typename vector_ref<N, T>::type_t>(b);        \
+}                                                                           \
+template <typename U, typename B>                                           \
+typename std::enable_if<matrix_view_scalar<B, U>::value,                    \
+                        typename matrix_view_scalar<B, U>::result_t>::type  \
+operator SYMBOL(const U & a, const B & b)                                   \
+{                                                                           \
+    return a SYMBOL typename matrix_view_scalar<B, U>::result_t(b);         \
+}
+
+VECMAT_VIEW_SCALAR_OPERATOR(+)
+VECMAT_VIEW_SCALAR_OPERATOR(-)
+VECMAT_VIEW_SCALAR_OPERATOR(*)
+
+#undef VECMAT_VIEW_SCALAR_OPERATOR
+
+/** ### Comparison operators
+ */
+template <typename A, typename B>
+typename std::enable_if<vector_view_pair<A, B>::value, bool>::type
+operator==(const A & a, const B & b)
+{
+    const typename vector_traits<A>::type_t * x =
+        vector_traits<A>::pointer(a);
+    const typename vector_traits<B>::type_t * y =
+        vector_traits<B>::pointer(b);
+    const size_t incx = vector_traits<A>::inc(a);
+    const size_t incy = vector_traits<B>::inc(b);
+    for (size_t i = 0; i < vector_traits<A>::size; ++i)
+        if (x[i * incx] != y[i * incy])
+            return false;
+    return true;
+}
+template <typename A, typename B>
+typename std::enable_if<matrix_view_pair<A, B>::value, bool>::type
+operator==(const A & a, const B & b)
+{
+    for (size_t j = 0; j < matrix_traits<A>::cols; ++j)
+        for (size_t i = 0; i < matrix_traits<A>::rows; ++i)
+            if (a(i, j) != b(i, j))
+                return false;
+    return true;
+}
+template <typename A, typename B>
+typename std::enable_if<vector_view_pair<A, B>::value ||
+                        matrix_view_pair<A, B>::value, bool>::type
+operator!=(const A & a, const B & b)
+{
+    return ! (a == b);
+}
+
+/** ## Products
+ *
+ * The inner products read the operands in place.  The matrix-matrix
+ * product goes straight to `gemm` with the leading dimensions and
+ * transposes of the views.  The matrix-vector products go to `gemv`
+ * with the vector gathered into a contiguous copy, which is cheap next
+ * to the matrix.
+ */
+template <typename A, typename B>
+typename std::enable_if<vector_view_pair<A, B>::value,
+                        typename vector_traits<A>::type_t>::type
+dot(const A & a, const B & b)
+{
+    const typename vector_traits<A>::type_t * x =
+        vector_traits<A>::pointer(a);
+    const typename vector_traits<B>::type_t * y =
+        vector_traits<B>::pointer(b);
+    const size_t incx = vector_traits<A>::inc(a);
+    const size_t incy = vector_traits<B>::inc(b);
+    typename vector_traits<A>::type_t ret = 0;
+    for (size_t i = 0; i < vector_traits<A>::size; ++i)
+        ret += x[i * incx] * y[i * incy];
+    return ret;
+}
+
+template <typename A, typename B>
+typename std::enable_if<
+    matrix_traits<A>::value && matrix_traits<B>::value &&
+    (matrix_traits<A>::view || matrix_traits<B>::view) &&
+    matrix_traits<A>::cols == matrix_traits<B>::rows,
+    matrix<matrix_traits<A>::rows, matrix_traits<B>::cols,
+           typename matrix_traits<A>::type_t> >::type
+dot(const A & a, const B & b)
+{
+    typedef matrix_traits<A> TA;
+    typedef matrix_traits<B> TB;
+    matrix<TA::rows, TB::cols, typename TA::type_t> c;
+    gemm(TA::trans, TB::trans, TA::rows, TB::cols, TA::cols,
+         TA::pointer(a), TA::ld(a),
+         TB::pointer(b), TB::ld(b),
+         c.data, TA::rows);
+    return c;
+}
+
+template <typename A, typename B>
+typename std::enable_if<
+    matrix_traits<A>::value && vector_traits<B>::value &&
+    (matrix_traits<A>::view || vector_traits<B>::view) &&
+    matrix_traits<A>::cols == vector_traits<B>::size,
+    vector<matrix_traits<A>::rows, typename matrix_traits<A>::type_t>
+    >::type
+dot(const A & a, const B & b)
+{
+    typedef matrix_traits<A> TA;
+    typedef vector_traits<B> TB;
+    typedef typename TA::type_t T;
+    const vector<TB::size, T> x = b;
+    vector<TA::rows, T> c;
+    if (TA::trans)
+        gemv(true, TA::cols, TA::rows, TA::pointer(a), TA::ld(a),
+             x.data, c.data);
+    else
+        gemv(false, TA::rows, TA::cols, TA::pointer(a), TA::ld(a),
+             x.data, c.data);
+    return c;
+}
+
+template <typename A, typename B>
+typename std::enable_if<
+    vector_traits<A>::value && matrix_traits<B>::value &&
+    (vector_traits<A>::view || matrix_traits<B>::view) &&
+    vector_traits<A>::size == matrix_traits<B>::rows,
+    vector<matrix_traits<B>::cols, typename matrix_traits<B>::type_t>
+    >::type
+dot(const A & a, const B & b)
+{
+    typedef vector_traits<A> TA;
+    typedef matrix_traits<B> TB;
+    typedef typename TB::type_t T;
+    const vector<TA::size, T> x = a;
+    vector<TB::cols, T> c;
+    if (TB::trans)
+        gemv(false, TB::cols, TB::rows, TB::pointer(b), TB::ld(b),
+             x.data, c.data);
+    else
+        gemv(true, TB::rows, TB::cols, TB::pointer(b), TB::ld(b),
+             x.data, c.data);
+    return c;
+}
+
+/**
+ * @brief The cross product
+ *
+ * The operands are at most four elements, so they are simply copied
+ * and handed to the owning `cross`.
+ */
+template <typename A, typename B>
+typename std::enable_if<
+    vector_traits<A>::value && vector_traits<B>::value &&
+    (vector_traits<A>::view || vector_traits<B>::view),
+    vector<3, typename vector_traits<A>::type_t> >::type
+cross(const A & a, const B & b)
+{
+    typedef typename vector_traits<A>::type_t T;
+    const vector<vector_traits<A>::size, T> x = a;
+    const vector<vector_traits<B>::size, T> y = b;
+    return cross(x, y);
+}
+
+/** ## Stream operators
+ *
+ * These follow the owning types.  Reading goes through a temporary so
+ * a failed read leaves the same quiet NaNs behind.
+ */
+template <size_t N, typename T>
+std::ostream & operator<<(std::ostream & os, const vector_ref<N, T> & a)
+{
+    return os << vector<N, typename vector_ref<N, T>::type_t>(a);
+}
+template <size_t N, typename T>
+std::istream & operator>>(std::istream & is, vector_ref<N, T> a)
+{
+    vector<N, T> b;
+    is >> b;
+    a = b;
+    return is;
+}
+template <size_t N, size_t M, typename T>
+std::ostream & operator<<(std::ostream & os, const matrix_map<N, M, T> & a)
+{
+    return os << matrix<N, M, typename matrix_map<N, M, T>::type_t>(a);
+}
+template <size_t N, size_t M, typename T>
+std::istream & operator>>(std::istream & is, matrix_map<N, M, T> a)
+{
+    matrix<N, M, T> b;
+    is >> b;
+    a = b;
+    return is;
+}
+
+}; // end namespace vecmat
+
+#endif
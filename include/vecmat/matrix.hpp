@@ -35,7 +35,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 #include <limits>
 #include <stdexcept>
-
+#include <type_traits>
+
+#include "vecmat/aligned.hpp"
+#include "vecmat/bounds.hpp"
+#include "vecmat/gemm.hpp"
+#include "vecmat/gemv.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/unroll.hpp"
 #include "vecmat/vector.hpp"
 
 namespace vecmat {
@@ -65,7 +72,8 @@ struct matrix {
 
     /** ## Member data
      */
-    T data[N * M];      //! The internal storage for the array
+    //! The internal storage for the array
+    alignas(detail::storage_alignment<T, N * M>::value) T data[N * M];
 
     /** ## Type definitions
      */
@@ -80,19 +88,19 @@ struct matrix {
      * because we primarily care about forward traversal across the
      * entire data of the matrix.
      */
-    iterator begin(void)
+    VECMAT_CONSTEXPR iterator begin(void)
     {
         return data;
     }
-    iterator end(void)
+    VECMAT_CONSTEXPR iterator end(void)
     {
         return data + N * M;
     }
-    const_iterator cbegin(void) const
+    VECMAT_CONSTEXPR const_iterator cbegin(void) const
     {
         return const_cast<const_iterator>(data);
     }
-    const_iterator cend(void) const
+    VECMAT_CONSTEXPR const_iterator cend(void) const
     {
         return const_cast<const_iterator>(data + N * M);
     }
@@ -100,43 +108,42 @@ struct matrix {
     /** ## Access operations
      *
      * We provide the usual `[i]` zero based access operator, but we
-     * also provide `(i)` for symmetry with the matrix class.  These
-     * will throw std::out_of_range if the index is larger than the
-     * matrix.
+     * also provide `(i, j)` for the `i`-th row and `j`-th column.  The
+     * indices are checked according to `VECMAT_BOUNDS_CHECK` (see
+     * `vecmat/bounds.hpp`).
      */
-    const T & operator[](const size_t & i) const
+    VECMAT_CONSTEXPR const T & operator[](const size_t & i) const
     {
-        if (i >= N * M)
-            std::out_of_range(__func__);
+        detail::check_bounds(i, N * M, __func__);
         return data[i];
     }
-    T & operator[](const size_t & i)
+    VECMAT_CONSTEXPR T & operator[](const size_t & i)
     {
-        if (i >= N * M)
-            std::out_of_range(__func__);
+        detail::check_bounds(i, N * M, __func__);
         return data[i];
     }
-    const T & operator()(const size_t & i, const size_t & j) const
+    VECMAT_CONSTEXPR const T &
+    operator()(const size_t & i, const size_t & j) const
     {
-        size_t k = i + j * N;
-        return operator[](k);
+        detail::check_bounds(i, N, __func__);
+        detail::check_bounds(j, M, __func__);
+        return data[i + j * N];
     }
-    T & operator()(const size_t & i, const size_t & j)
+    VECMAT_CONSTEXPR T & operator()(const size_t & i, const size_t & j)
     {
-        size_t k = i + j * N;
-        return operator[](k);
+        detail::check_bounds(i, N, __func__);
+        detail::check_bounds(j, M, __func__);
+        return data[i + j * N];
     }
 
     /** ## Unary operator
      *
      * Negating a matrix negates each element of the matrix.
      */
-    matrix operator-()
+    VECMAT_CONSTEXPR matrix operator-() const
     {
-        matrix<N, M, T> b;
-        for (size_t i = 0; i < N * M; ++i)
-            b[i] = -operator[](i);
-
+        matrix<N, M, T> b {};
+        detail::negate(b.data, data, detail::unrolled_t<N, M>());
         return b;
     }
 
@@ -145,10 +152,9 @@ struct matrix {
      * Scalar assignment broadcasts the scalar to every element of the
      * matrix.
      */
-    matrix operator=(T a)
+    VECMAT_CONSTEXPR matrix operator=(T a)
     {
-        for (auto & x: *this)
-            x = a;
+        detail::fill(data, a, detail::unrolled_t<N, M>());
         return *this;
     }
 
@@ -162,58 +168,89 @@ struct matrix {
      */
     /** ### Scalar compound assignment
      */
-    matrix & operator+=(const T & a)
+    VECMAT_CONSTEXPR matrix & operator+=(const T & a)
     {
-        for (auto & v: *this)
-            v += a;
+        detail::broadcast<simd::plus>(data, a, detail::unrolled_t<N, M>());
         return *this;
     }
-    matrix & operator-=(const T & a)
+    VECMAT_CONSTEXPR matrix & operator-=(const T & a)
     {
-        for (auto & v: *this)
-            v -= a;
+        detail::broadcast<simd::minus>(data, a, detail::unrolled_t<N, M>());
         return *this;
     }
-    matrix & operator*=(const T & a)
+    VECMAT_CONSTEXPR matrix & operator*=(const T & a)
     {
-        for (auto & v: *this)
-            v *= a;
+        detail::broadcast<simd::multiplies>(data, a,
+                                            detail::unrolled_t<N, M>());
         return *this;
     }
-    matrix & operator/=(const T & a)
+    VECMAT_CONSTEXPR matrix & operator/=(const T & a)
     {
-        for (auto & v: *this)
-            v /= a;
+        detail::broadcast<simd::divides>(data, a, detail::unrolled_t<N, M>());
         return *this;
     }
 
     /** ### Matrix compound assignments
      */
-    matrix & operator+=(const matrix & a)
+    VECMAT_CONSTEXPR matrix & operator+=(const matrix & a)
     {
-        std::transform(a.cbegin(), a.cend(), begin(), begin(),
-                       [](T s, T t) -> T { return t + s; });
+        detail::transform<simd::plus>(data, a.data,
+                                      detail::unrolled_t<N, M>());
         return *this;
     }
-    matrix & operator-=(const matrix & a)
+    VECMAT_CONSTEXPR matrix & operator-=(const matrix & a)
     {
-        std::transform(a.cbegin(), a.cend(), begin(), begin(),
-                       [](T s, T t) -> T { return t - s; });
+        detail::transform<simd::minus>(data, a.data,
+                                       detail::unrolled_t<N, M>());
         return *this;
     }
-    matrix & operator*=(const matrix & a)
+    VECMAT_CONSTEXPR matrix & operator*=(const matrix & a)
     {
-        std::transform(a.cbegin(), a.cend(), begin(), begin(),
-                       [](T s, T t) -> T { return t * s; });
+        detail::transform<simd::multiplies>(data, a.data,
+                                            detail::unrolled_t<N, M>());
         return *this;
     }
-    matrix & operator/=(const matrix & a)
+    VECMAT_CONSTEXPR matrix & operator/=(const matrix & a)
     {
-        std::transform(a.cbegin(), a.cend(), begin(), begin(),
-                       [](T s, T t) -> T { return t / s; });
+        detail::transform<simd::divides>(data, a.data,
+                                         detail::unrolled_t<N, M>());
         return *this;
     }
 
+    /** ### Expression assignment
+     *
+     * Assigning a lazy expression evaluates it in a single pass.  These
+     * are only usable after including `vecmat/expression.hpp`, and the
+     * expression must have exactly this shape and element type.
+     */
+    template <typename E>
+    matrix & operator=(const expression<E> & e)
+    {
+        static_assert(std::is_same<typename E::result_t, matrix>::value,
+                      "the expression must have the shape of the matrix");
+        e.self().evaluate(data);
+        return *this;
+    }
+    template <typename E>
+    matrix & operator+=(const expression<E> & e)
+    {
+        return *this = lazy(*this) + e;
+    }
+    template <typename E>
+    matrix & operator-=(const expression<E> & e)
+    {
+        return *this = lazy(*this) - e;
+    }
+    template <typename E>
+    matrix & operator*=(const expression<E> & e)
+    {
+        return *this = lazy(*this) * e;
+    }
+    template <typename E>
+    matrix & operator/=(const expression<E> & e)
+    {
+        return *this = lazy(*this) / e;
+    }
 
     /** ## Stream operations
      *
@@ -235,21 +272,27 @@ struct matrix {
  * operations, we need to handle the scalar on the left or the scalar on
  * the right.  The only exception is division where dividing a scalar by
  * a matrix does not make sense.  In all cases, we operate element-wise
- * and broadcast the scalars.
+ * and broadcast the scalars.  As with vectors, only types satisfying
+ * `is_scalar` are broadcast.
  */
 /** ### Addition
  */
 template <size_t N, size_t M, typename T, typename U>
-matrix<N, M, T> operator+(const U & a, matrix<N, M, T> b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, matrix<N, M, T>>::type
+operator+(const U & a, matrix<N, M, T> b)
 {
     return b += static_cast<T>(a);
 }
 template <size_t N, size_t M, typename T, typename U>
-matrix<N, M, T> operator+(matrix<N, M, T> a, const U & b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, matrix<N, M, T>>::type
+operator+(matrix<N, M, T> a, const U & b)
 {
     return a += static_cast<T>(b);
 }
 template <size_t N, size_t M, typename T>
+VECMAT_CONSTEXPR
 matrix<N, M, T> operator+(matrix<N, M, T> a, const matrix<N, M, T> & b)
 {
     return a += b;
@@ -258,16 +301,21 @@ matrix<N, M, T> operator+(matrix<N, M, T> a, const matrix<N, M, T> & b)
 /** ### Subtraction
  */
 template <size_t N, size_t M, typename T, typename U>
-matrix<N, M, T> operator-(const U & a, matrix<N, M, T> b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, matrix<N, M, T>>::type
+operator-(const U & a, matrix<N, M, T> b)
 {
     return (-b) += static_cast<T>(a);
 }
 template <size_t N, size_t M, typename T, typename U>
-matrix<N, M, T> operator-(matrix<N, M, T> a, const U & b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, matrix<N, M, T>>::type
+operator-(matrix<N, M, T> a, const U & b)
 {
     return a -= static_cast<T>(b);
 }
 template <size_t N, size_t M, typename T>
+VECMAT_CONSTEXPR
 matrix<N, M, T> operator-(matrix<N, M, T> a, const matrix<N, M, T> & b)
 {
     return a -= b;
@@ -276,16 +324,21 @@ matrix<N, M, T> operator-(matrix<N, M, T> a, const matrix<N, M, T> & b)
 /** ### Multiplication
  */
 template <size_t N, size_t M, typename T, typename U>
-matrix<N, M, T> operator*(const U & a, matrix<N, M, T> b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, matrix<N, M, T>>::type
+operator*(const U & a, matrix<N, M, T> b)
 {
     return b *= static_cast<T>(a);
 }
 template <size_t N, size_t M, typename T, typename U>
-matrix<N, M, T> operator*(matrix<N, M, T> a, const U & b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, matrix<N, M, T>>::type
+operator*(matrix<N, M, T> a, const U & b)
 {
     return a *= static_cast<T>(b);
 }
 template <size_t N, size_t M, typename T>
+VECMAT_CONSTEXPR
 matrix<N, M, T> operator*(matrix<N, M, T> a, const matrix<N, M, T> & b)
 {
     return a *= b;
@@ -294,11 +347,14 @@ matrix<N, M, T> operator*(matrix<N, M, T> a, const matrix<N, M, T> & b)
 /** ### Division
  */
 template <size_t N, size_t M, typename T, typename U>
-matrix<N, M, T> operator/(matrix<N, M, T> a, const U & b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, matrix<N, M, T>>::type
+operator/(matrix<N, M, T> a, const U & b)
 {
     return a /= static_cast<T>(b);
 }
 template <size_t N, size_t M, typename T>
+VECMAT_CONSTEXPR
 matrix<N, M, T> operator/(matrix<N, M, T> a, const matrix<N, M, T> & b)
 {
     return a /= b;
@@ -310,18 +366,20 @@ matrix<N, M, T> operator/(matrix<N, M, T> a, const matrix<N, M, T> & b)
  * matrices of different lengths are never equal.
  */
 template <size_t N, size_t M, size_t I, size_t J, typename T>
+VECMAT_CONSTEXPR
 bool operator==(const matrix<N, M, T> & a, const matrix<I, J, T> & b)
 {
     if (N != I || M != J)
         return false;
 
     for (size_t i = 0; i < N * M; ++i)
-        if (a[i] != b[i])
+        if (a.data[i] != b.data[i])
             return false;
 
     return true;
 }
 template <size_t N, size_t M, size_t I, size_t J, typename T>
+VECMAT_CONSTEXPR
 bool operator!=(const matrix<N, M, T> & a, const matrix<I, J, T> & b)
 {
     return ! operator==(a, b);
@@ -332,39 +390,129 @@ bool operator!=(const matrix<N, M, T> & a, const matrix<I, J, T> & b)
  *
  * We have three forms of the inner product: matrix-matrix,
  * vector-matrix, and matrix-vector.  Note the order of the matrix and
- * vector dictate the order of the multiplication.
+ * vector dictate the order of the multiplication.  The matrix-matrix
+ * product is handed to the blocked `gemm` once the matrices are large
+ * enough to fall out of cache.  The other two go to `gemv`, which walks
+ * the columns contiguously.
+ */
+namespace detail {
+
+/** Small products are unrolled and the rest go to the kernels
  */
+template <size_t N, size_t M, size_t O, typename T, size_t... K>
+VECMAT_CONSTEXPR void
+matrix_product(const T * a, const T * b, T * c, index_sequence<K...> k)
+{
+    product<N, M>(a, b, c, k);
+}
+template <size_t N, size_t M, size_t O, typename T, size_t L>
+VECMAT_CONSTEXPR void
+matrix_product(const T * a, const T * b, T * c, loop<L> l)
+{
+    if (VECMAT_CONSTANT_EVALUATED())
+        product<N, M>(a, b, c, l);
+    else if (O == 1)
+        gemv(false, N, M, a, N, b, c);
+    else
+        gemm(N, O, M, a, N, b, M, c, N);
+}
+template <size_t N, size_t M, typename T, size_t... K>
+VECMAT_CONSTEXPR void
+matrix_product_t(const T * a, const T * b, T * c, index_sequence<K...> k)
+{
+    product_t<N>(a, b, c, k);
+}
+template <size_t N, size_t M, typename T, size_t L>
+VECMAT_CONSTEXPR void
+matrix_product_t(const T * a, const T * b, T * c, loop<L> l)
+{
+    if (VECMAT_CONSTANT_EVALUATED())
+        product_t<N>(a, b, c, l);
+    else
+        gemv(true, N, M, a, N, b, c);
+}
+
+}; // end namespace detail
+
 template <size_t N, size_t M, size_t O, typename T>
-matrix<N, O, T> dot(const matrix<N, M, T> & a, const matrix<M, O, T> & b)
+VECMAT_CONSTEXPR matrix<N, O, T>
+dot(const matrix<N, M, T> & a, const matrix<M, O, T> & b)
 {
     matrix<N, O, T> c {};
-    for (size_t o = 0; o < O; ++o)
-        for (size_t n = 0; n < N; ++n)
-            for (size_t m = 0; m < M; ++m)
-                    c(n, o) += a(n, m) * b(m, o);
-
+    detail::matrix_product<N, M, O>(a.data, b.data, c.data,
+                                    detail::product_indices<N, M, O>());
     return c;
 }
 
 template <size_t N, size_t M, typename T>
-vector<N, T> dot(const matrix<N, M, T> & a, const vector<M, T> & b)
+VECMAT_CONSTEXPR vector<N, T>
+dot(const matrix<N, M, T> & a, const vector<M, T> & b)
 {
     vector<N, T> c {};
-    for (size_t n = 0; n < N; ++n)
-        for (size_t m = 0; m < M; ++m)
-                c(n) += a(n, m) * b(m);
-
+    detail::matrix_product<N, M, 1>(a.data, b.data, c.data,
+                                    detail::product_indices<N, M, 1>());
     return c;
 }
 
 template <size_t N, size_t M, typename T>
-vector<M, T> dot(const vector<N, T> & a, const matrix<N, M, T> & b)
+VECMAT_CONSTEXPR vector<M, T>
+dot(const vector<N, T> & a, const matrix<N, M, T> & b)
 {
     vector<M, T> c {};
-    for (size_t n = 0; n < N; ++n)
-        for (size_t m = 0; m < M; ++m)
-                c(m) += a(n) * b(n, m);
+    detail::matrix_product_t<N, M>(b.data, a.data, c.data,
+                                   detail::product_indices<M, N, 1>());
+    return c;
+}
 
+/** ### 4x4 products
+ *
+ * The model-view-projection compositions and vertex transforms in a
+ * rendering pipeline are almost exclusively 4x4 products.  These
+ * bypass the generic loops and use the broadcast kernel which keeps the
+ * left hand matrix in registers.
+ */
+VECMAT_CONSTEXPR inline matrix<4, 4, float>
+dot(const matrix<4, 4, float> & a, const matrix<4, 4, float> & b)
+{
+    matrix<4, 4, float> c {};
+    if (VECMAT_CONSTANT_EVALUATED())
+        detail::product<4, 4>(a.data, b.data, c.data,
+                              detail::make_index_sequence<16>());
+    else
+        simd::mat4_columns(a.data, b.data, c.data, 4);
+    return c;
+}
+VECMAT_CONSTEXPR inline matrix<4, 4, double>
+dot(const matrix<4, 4, double> & a, const matrix<4, 4, double> & b)
+{
+    matrix<4, 4, double> c {};
+    if (VECMAT_CONSTANT_EVALUATED())
+        detail::product<4, 4>(a.data, b.data, c.data,
+                              detail::make_index_sequence<16>());
+    else
+        simd::mat4_columns(a.data, b.data, c.data, 4);
+    return c;
+}
+VECMAT_CONSTEXPR inline vector<4, float>
+dot(const matrix<4, 4, float> & a, const vector<4, float> & b)
+{
+    vector<4, float> c {};
+    if (VECMAT_CONSTANT_EVALUATED())
+        detail::product<4, 4>(a.data, b.data, c.data,
+                              detail::make_index_sequence<4>());
+    else
+        simd::mat4_columns(a.data, b.data, c.data, 1);
+    return c;
+}
+VECMAT_CONSTEXPR inline vector<4, double>
+dot(const matrix<4, 4, double> & a, const vector<4, double> & b)
+{
+    vector<4, double> c {};
+    if (VECMAT_CONSTANT_EVALUATED())
+        detail::product<4, 4>(a.data, b.data, c.data,
+                              detail::make_index_sequence<4>());
+    else
+        simd::mat4_columns(a.data, b.data, c.data, 1);
     return c;
 }
 
@@ -438,13 +586,11 @@ std::istream & operator>>(std::istream & is, matrix<N, M, T> & a)
  * type cast the content.
  */
 template <size_t N, size_t M, typename T, size_t I, size_t J, typename U>
-vecmat::matrix<N, M, T> resize_cast(const vecmat::matrix<I, J, U> & a)
+VECMAT_CONSTEXPR vecmat::matrix<N, M, T>
+resize_cast(const vecmat::matrix<I, J, U> & a)
 {
     vecmat::matrix<N, M, T> b {};
-    for (size_t m = 0; m < M; ++m)
-        for (size_t n = 0; n < N; ++n)
-            b(n, m) = static_cast<T>(n < I & m < J ? a(n, m) : 0);
-
+    detail::resize<N, I, J>(b.data, a.data, detail::unrolled_t<N, M>());
     return b;
 }
 
@@ -468,12 +614,11 @@ using mat4 = matrix<4, 4, T>;
 /** Identity matrix
  */
 template <size_t N, typename T>
-matrix<N, N, T> eye(void)
+VECMAT_CONSTEXPR matrix<N, N, T> eye(void)
 {
     matrix<N, N, T> I {};
-    for (size_t n = 0; n < N; ++n)
-        I(n, n) = static_cast<T>(1);
-
+    detail::diagonal<N>(I.data, static_cast<T>(1),
+                        detail::unrolled_t<N>());
     return I;
 }
 
@@ -0,0 +1,555 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_PADDED_H
+#define VECMAT_PADDED_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <type_traits>
+
+#include "vecmat/bounds.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/vector.hpp"
+
+namespace vecmat {
+
+namespace detail {
+
+/** ## Padded storage
+ *
+ * The padded types round every column up to a whole number of four
+ * element registers (`simd::quad`) and align it to one, so a `vec3` or
+ * a column of a `mat3` fills a register and every kernel uses aligned
+ * full width loads and stores.  Initialization and every operation
+ * keep the padding at zero, except default initialization, which leaves
+ * it indeterminate like the elements.  The products therefore mask the
+ * padding of their inputs and clear that of their results.
+ */
+template <size_t N>
+struct padded_rows {
+    static const size_t value = (N + 3) / 4 * 4;
+};
+
+template <typename T>
+struct padded_alignment {
+    static const size_t value = 4 * sizeof(T) < 64 ? 4 * sizeof(T) : 64;
+};
+
+/** Apply `a[i] = a[i] op b[i]` over the `n` padded elements
+ */
+template <template <typename> class Op, typename T>
+void padded_transform(T * a, const T * b, size_t n)
+{
+    typedef simd::quad<T> Q;
+    for (size_t i = 0; i < n; i += Q::width)
+        Q::store(a + i, Op<Q>::apply(Q::load(a + i), Q::load(b + i)));
+}
+
+/** Apply `a[i] = a[i] op b` over the `n` padded elements
+ */
+template <template <typename> class Op, typename T>
+void padded_broadcast(T * a, const T & b, size_t n)
+{
+    typedef simd::quad<T> Q;
+    const typename Q::type s = Q::set1(b);
+    for (size_t i = 0; i < n; i += Q::width)
+        Q::store(a + i, Op<Q>::apply(Q::load(a + i), s));
+}
+
+/** Restore the zero padding below row `N` of `M` columns after an
+ * operation that need not preserve it (anything with a scalar, and
+ * division)
+ */
+template <size_t N, size_t M, typename T>
+void clear_padding(T * a)
+{
+    const size_t P = padded_rows<N>::value;
+    for (size_t j = 0; j < M; ++j)
+        for (size_t i = N; i < P; ++i)
+            a[i + j * P] = static_cast<T>(0);
+}
+
+/** `c = a b` for the padded `P` by `M` matrix `a` and `count` columns
+ * of `b` that are `ldb` apart.  The columns of `a` stay in registers
+ * across the output columns when they fit.
+ */
+template <size_t P, size_t M, typename T>
+void padded_columns(const T * a, const T * b, size_t ldb, T * c,
+                    size_t count)
+{
+    typedef simd::quad<T> Q;
+    for (size_t j = 0; j < count; ++j, b += ldb, c += P)
+        for (size_t i = 0; i < P; i += Q::width)
+        {
+            typename Q::type r = Q::mul(Q::load(a + i), Q::set1(b[0]));
+            for (size_t k = 1; k < M; ++k)
+                r = Q::fmadd(Q::load(a + i + k * P), Q::set1(b[k]), r);
+            Q::store(c + i, r);
+        }
+}
+
+/** The inner product of `N` padded elements
+ *
+ * The last register is copied with its padding lanes zeroed, so
+ * whatever the padding holds never reaches the sum.
+ */
+template <size_t N, typename T>
+T padded_inner(const T * a, const T * b)
+{
+    typedef simd::quad<T> Q;
+    const size_t last = padded_rows<N>::value - Q::width;
+    alignas(padded_alignment<T>::value) T x[Q::width] = {};
+    alignas(padded_alignment<T>::value) T y[Q::width] = {};
+    std::copy(a + last, a + N, x);
+    std::copy(b + last, b + N, y);
+    typename Q::type r = Q::mul(Q::load(x), Q::load(y));
+    for (size_t i = 0; i < last; i += Q::width)
+        r = Q::fmadd(Q::load(a + i), Q::load(b + i), r);
+
+    Q::store(x, r);
+    return (x[0] + x[1]) + (x[2] + x[3]);
+}
+
+}; // end namespace detail
+
+template <size_t N, typename T>
+struct padded_vector {
+    /** A vector stored in whole SIMD registers
+     *
+     * Like `vector`, this is an aggregate, and aggregate initialization
+     * zeroes the padding
+     *
+     *     padded_vector<3, float> a {{1.0f, 2.0f, 3.0f}};
+     *
+     * A default initialized `padded_vector<3, float> a;` leaves the
+     * padding indeterminate.  The element-wise operators then carry it
+     * along, but the products and comparisons never read it.
+     *
+     * The storage is over-aligned.  Before C++17 the standard
+     * containers do not honor that, so keep these in containers using
+     * `aligned_allocator`.
+     */
+    static_assert(std::is_floating_point<T>::value,
+                  "padded storage needs a floating point type");
+
+    static const size_t padded = detail::padded_rows<N>::value;
+
+    /** ## Member data
+     */
+    //! The internal storage with the padding after element `N - 1`
+    alignas(detail::padded_alignment<T>::value) T data[padded];
+
+    typedef T type_t;
+
+    /** ## Access operations
+     *
+     * The index is checked according to `VECMAT_BOUNDS_CHECK` against
+     * the length of the vector, not the padding.
+     */
+    const T & operator[](const size_t & i) const
+    {
+        detail::check_bounds(i, N, __func__);
+        return data[i];
+    }
+    T & operator[](const size_t & i)
+    {
+        detail::check_bounds(i, N, __func__);
+        return data[i];
+    }
+    const T & operator()(const size_t & i) const
+    {
+        return operator[](i);
+    }
+    T & operator()(const size_t & i)
+    {
+        return operator[](i);
+    }
+
+    /** The tightly packed vector
+     */
+    operator vector<N, T>() const
+    {
+        vector<N, T> a {};
+        std::copy(data, data + N, a.data);
+        return a;
+    }
+
+    /** ## Unary operator
+     */
+    padded_vector operator-() const
+    {
+        padded_vector b {};
+        detail::padded_transform<simd::minus>(b.data, data, padded);
+        return b;
+    }
+
+    /** ## Compound assignment
+     */
+    padded_vector & operator+=(const T & a)
+    {
+        detail::padded_broadcast<simd::plus>(data, a, padded);
+        detail::clear_padding<N, 1>(data);
+        return *this;
+    }
+    padded_vector & operator-=(const T & a)
+    {
+        detail::padded_broadcast<simd::minus>(data, a, padded);
+        detail::clear_padding<N, 1>(data);
+        return *this;
+    }
+    padded_vector & operator*=(const T & a)
+    {
+        detail::padded_broadcast<simd::multiplies>(data, a, padded);
+        detail::clear_padding<N, 1>(data);
+        return *this;
+    }
+    padded_vector & operator/=(const T & a)
+    {
+        detail::padded_broadcast<simd::divides>(data, a, padded);
+        detail::clear_padding<N, 1>(data);
+        return *this;
+    }
+    padded_vector & operator+=(const padded_vector & a)
+    {
+        detail::padded_transform<simd::plus>(data, a.data, padded);
+        return *this;
+    }
+    padded_vector & operator-=(const padded_vector & a)
+    {
+        detail::padded_transform<simd::minus>(data, a.data, padded);
+        return *this;
+    }
+    padded_vector & operator*=(const padded_vector & a)
+    {
+        detail::padded_transform<simd::multiplies>(data, a.data, padded);
+        return *this;
+    }
+    padded_vector & operator/=(const padded_vector & a)
+    {
+        detail::padded_transform<simd::divides>(data, a.data, padded);
+        detail::clear_padding<N, 1>(data);
+        return *this;
+    }
+};
+
+template <size_t N, size_t M, typename T>
+struct padded_matrix {
+    /** A column-major matrix with each column padded to whole SIMD
+     * registers
+     *
+     * Element `(i, j)` lives at `data[i + j * padded]`.  As with
+     * `padded_vector` the padding is zero unless default initialized,
+     * and the storage is over-aligned.
+     */
+    static_assert(std::is_floating_point<T>::value,
+                  "padded storage needs a floating point type");
+
+    static const size_t padded = detail::padded_rows<N>::value;
+
+    /** ## Member data
+     */
+    //! The internal storage, `padded` elements per column
+    alignas(detail::padded_alignment<T>::value) T data[padded * M];
+
+    typedef T type_t;
+
+    /** ## Access operations
+     *
+     * `(i, j)` is the `i`-th row and `j`-th column.  The indices are
+     * checked according to `VECMAT_BOUNDS_CHECK`.
+     */
+    const T & operator()(const size_t & i, const size_t & j) const
+    {
+        detail::check_bounds(i, N, __func__);
+        detail::check_bounds(j, M, __func__);
+        return data[i + j * padded];
+    }
+    T & operator()(const size_t & i, const size_t & j)
+    {
+        detail::check_bounds(i, N, __func__);
+        detail::check_bounds(j, M, __func__);
+        return data[i + j * padded];
+    }
+
+    /** The tightly packed matrix
+     */
+    operator matrix<N, M, T>() const
+    {
+        matrix<N, M, T> a {};
+        for (size_t j = 0; j < M; ++j)
+            std::copy(data + j * padded, data + j * padded + N,
+                      a.data + j * N);
+        return a;
+    }
+
+    /** ## Unary operator
+     */
+    padded_matrix operator-() const
+    {
+        padded_matrix b {};
+        detail::padded_transform<simd::minus>(b.data, data, padded * M);
+        return b;
+    }
+
+    /** ## Compound assignment
+     */
+    padded_matrix & operator+=(const T & a)
+    {
+        detail::padded_broadcast<simd::plus>(data, a, padded * M);
+        detail::clear_padding<N, M>(data);
+        return *this;
+    }
+    padded_matrix & operator-=(const T & a)
+    {
+        detail::padded_broadcast<simd::minus>(data, a, padded * M);
+        detail::clear_padding<N, M>(data);
+        return *this;
+    }
+    padded_matrix & operator*=(const T & a)
+    {
+        detail::padded_broadcast<simd::multiplies>(data, a, padded * M);
+        detail::clear_padding<N, M>(data);
+        return *this;
+    }
+    padded_matrix & operator/=(const T & a)
+    {
+        detail::padded_broadcast<simd::divides>(data, a, padded * M);
+        detail::clear_padding<N, M>(data);
+        return *this;
+    }
+    padded_matrix & operator+=(const padded_matrix & a)
+    {
+        detail::padded_transform<simd::plus>(data, a.data, padded * M);
+        return *this;
+    }
+    padded_matrix & operator-=(const padded_matrix & a)
+    {
+        detail::padded_transform<simd::minus>(data, a.data, padded * M);
+        return *this;
+    }
+    padded_matrix & operator*=(const padded_matrix & a)
+    {
+        detail::padded_transform<simd::multiplies>(data, a.data,
+                                                   padded * M);
+        return *this;
+    }
+    padded_matrix & operator/=(const padded_matrix & a)
+    {
+        detail::padded_transform<simd::divides>(data, a.data, padded * M);
+        detail::clear_padding<N, M>(data);
+        return *this;
+    }
+};
+
+/** ## Specializations
+ *
+ * The padding pays for itself on the three element types, which would
+ * otherwise need a partial register.
+ */
+template <typename T>
+using padded_vec3 = padded_vector<3, T>;
+
+template <typename T>
+using padded_mat3 = padded_matrix<3, 3, T>;
+
+/** ## Conversion
+ *
+ * Copy a tightly packed vector or matrix into padded storage.
+ */
+template <size_t N, typename T>
+padded_vector<N, T> pad(const vector<N, T> & a)
+{
+    padded_vector<N, T> b {};
+    std::copy(a.data, a.data + N, b.data);
+    return b;
+}
+template <size_t N, size_t M, typename T>
+padded_matrix<N, M, T> pad(const matrix<N, M, T> & a)
+{
+    padded_matrix<N, M, T> b {};
+    for (size_t j = 0; j < M; ++j)
+        std::copy(a.data + j * N, a.data + (j + 1) * N,
+                  b.data + j * b.padded);
+    return b;
+}
+
+/** ## Binary operators
+ */
+#define VECMAT_PADDED_OPERATOR(SYMBOL)                                      \
+template <size_t N, typename T>                                             \
+padded_vector<N, T> operator SYMBOL(const padded_vector<N, T> & a,          \
+                                    const padded_vector<N, T> & b)          \
+{                                                                           \
+    padded_vector<N, T> c = a;                                              \
+    return c SYMBOL##= b;                                                   \
+}                                                                           \
+template <size_t N, typename T, typename U>                                 \
+typename std::enable_if<is_scalar<U>::value, padded_vector<N, T> >::type    \
+operator SYMBOL(const padded_vector<N, T> & a, const U & b)                 \
+{                                                                           \
+    padded_vector<N, T> c = a;                                              \
+    return c SYMBOL##= static_cast<T>(b);                                   \
+}                                                                           \
+template <size_t N, size_t M, typename T>                                   \
+padded_matrix<N, M, T> operator SYMBOL(const padded_matrix<N, M, T> & a,    \
+                                       const padded_matrix<N, M, T> & b)    \
+{                                                                           \
+    padded_matrix<N, M, T> c = a;                                           \
+    return c SYMBOL##= b;                                                   \
+}                                                                           \
+template <size_t N, size_t M, typename T, typename U>                       \
+typename std::enable_if<is_scalar<U>::value,                                \
+                        padded_matrix<N, M, T> >::type                      \
+operator SYMBOL(const padded_matrix<N, M, T> & a, const U & b)              \
+{                                                                           \
+    padded_matrix<N, M, T> c = a;                                           \
+    return c SYMBOL##= static_cast<T>(b);                                   \
+}
+
+VECMAT_PADDED_OPERATOR(+)
+VECMAT_PADDED_OPERATOR(-)
+VECMAT_PADDED_OPERATOR(*)
+VECMAT_PADDED_OPERATOR(/)
+
+#undef VECMAT_PADDED_OPERATOR
+
+template <size_t N, typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, padded_vector<N, T> >::type
+operator+(const U & a, const padded_vector<N, T> & b)
+{
+    padded_vector<N, T> c = b;
+    return c += static_cast<T>(a);
+}
+template <size_t N, typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, padded_vector<N, T> >::type
+operator*(const U & a, const padded_vector<N, T> & b)
+{
+    padded_vector<N, T> c = b;
+    return c *= static_cast<T>(a);
+}
+template <size_t N, size_t M, typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, padded_matrix<N, M, T> >::type
+operator+(const U & a, const padded_matrix<N, M, T> & b)
+{
+    padded_matrix<N, M, T> c = b;
+    return c += static_cast<T>(a);
+}
+template <size_t N, size_t M, typename T, typename U>
+typename std::enable_if<is_scalar<U>::value, padded_matrix<N, M, T> >::type
+operator*(const U & a, const padded_matrix<N, M, T> & b)
+{
+    padded_matrix<N, M, T> c = b;
+    return c *= static_cast<T>(a);
+}
+
+/** ### Comparison operators
+ *
+ * Only the elements are compared, the padding is ignored.
+ */
+template <size_t N, typename T>
+bool operator==(const padded_vector<N, T> & a, const padded_vector<N, T> & b)
+{
+    return std::equal(a.data, a.data + N, b.data);
+}
+template <size_t N, typename T>
+bool operator!=(const padded_vector<N, T> & a, const padded_vector<N, T> & b)
+{
+    return ! operator==(a, b);
+}
+template <size_t N, size_t M, typename T>
+bool operator==(const padded_matrix<N, M, T> & a,
+                const padded_matrix<N, M, T> & b)
+{
+    for (size_t j = 0; j < M; ++j)
+        if (!std::equal(a.data + j * a.padded, a.data + j * a.padded + N,
+                        b.data + j * b.padded))
+            return false;
+    return true;
+}
+template <size_t N, size_t M, typename T>
+bool operator!=(const padded_matrix<N, M, T> & a,
+                const padded_matrix<N, M, T> & b)
+{
+    return ! operator==(a, b);
+}
+
+/** ## Products
+ *
+ * All of these run with full registers.  The inner product zeroes the
+ * padding lanes of its operands, and the matrix products clear the
+ * padding of the result, which is all the padding of `a` reaches.
+ */
+template <size_t N, typename T>
+T dot(const padded_vector<N, T> & a, const padded_vector<N, T> & b)
+{
+    return detail::padded_inner<N>(a.data, b.data);
+}
+template <size_t N, size_t M, typename T>
+padded_vector<N, T> dot(const padded_matrix<N, M, T> & a,
+                        const padded_vector<M, T> & b)
+{
+    padded_vector<N, T> c;
+    detail::padded_columns<padded_vector<N, T>::padded, M>(
+        a.data, b.data, b.padded, c.data, 1);
+    detail::clear_padding<N, 1>(c.data);
+    return c;
+}
+template <size_t N, size_t M, size_t O, typename T>
+padded_matrix<N, O, T> dot(const padded_matrix<N, M, T> & a,
+                           const padded_matrix<M, O, T> & b)
+{
+    padded_matrix<N, O, T> c;
+    detail::padded_columns<padded_matrix<N, O, T>::padded, M>(
+        a.data, b.data, b.padded, c.data, O);
+    detail::clear_padding<N, O>(c.data);
+    return c;
+}
+
+/** ## Stream operators
+ *
+ * These print the elements without the padding.
+ */
+template <size_t N, typename T>
+std::ostream & operator<<(std::ostream & os, const padded_vector<N, T> & a)
+{
+    return os << static_cast<vector<N, T> >(a);
+}
+template <size_t N, size_t M, typename T>
+std::ostream & operator<<(std::ostream & os,
+                          const padded_matrix<N, M, T> & a)
+{
+    return os << static_cast<matrix<N, M, T> >(a);
+}
+
+}; // end namespace vecmat
+
+#endif
@@ -0,0 +1,171 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_PARALLEL_H
+#define VECMAT_PARALLEL_H
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "vecmat/simd.hpp"
+#include "vecmat/stream.hpp"
+#include "vecmat/thread_pool.hpp"
+
+/** ## Parallel element-wise operations
+ *
+ * The element-wise operators, scalar fills, and `resize_cast` of the
+ * dynamic types split objects with at least `VECMAT_PARALLEL_THRESHOLD`
+ * elements across the thread pool.  Each thread gets one contiguous
+ * range that starts on a cache line, so no two threads ever write the
+ * same line.  Below the threshold, or with a single thread, they run
+ * on the calling thread as before.  Fills and casts large enough to
+ * stream do so within each range.
+ */
+#if ! defined(VECMAT_PARALLEL_THRESHOLD)
+#define VECMAT_PARALLEL_THRESHOLD (1 << 18)
+#endif
+
+namespace vecmat {
+
+namespace detail {
+
+/** Objects with fewer elements than this stay on one thread */
+static const size_t parallel_threshold = VECMAT_PARALLEL_THRESHOLD;
+
+/** The bytes the ranges of different threads are aligned to */
+static const size_t parallel_line = 64;
+
+/** Run `f(begin, end)` over `[0, count)` with one range per thread
+ *
+ * `work` is the number of elements touched, which decides whether to
+ * split at all.  The range boundaries are multiples of `align`.
+ */
+template <typename F>
+void parallel_chunks(size_t count, size_t work, size_t align, F f)
+{
+    const size_t threads = num_threads();
+    if (work < parallel_threshold || threads < 2 || count < 2 * align)
+    {
+        f(0, count);
+        return;
+    }
+    const size_t chunk = ((count + threads - 1) / threads + align - 1) /
+                         align * align;
+    parallel_for((count + chunk - 1) / chunk, [=](size_t t) {
+        f(t * chunk, std::min(count, (t + 1) * chunk));
+    });
+}
+
+/** The elements of `T` in a cache line
+ */
+template <typename T>
+size_t line_elements(void)
+{
+    return sizeof(T) < parallel_line ? parallel_line / sizeof(T) : 1;
+}
+
+/** `a[i] = Op(a[i], b[i])` for `i` in `[0, n)`
+ */
+template <template <typename> class Op, typename T>
+void parallel_transform(T * a, const T * b, size_t n)
+{
+    parallel_chunks(n, n, line_elements<T>(), [=](size_t i0, size_t i1) {
+        simd::transform<Op>(a + i0, b + i0, i1 - i0);
+    });
+}
+
+/** `a[i] = Op(a[i], b)` for `i` in `[0, n)`
+ */
+template <template <typename> class Op, typename T>
+void parallel_broadcast(T * a, const T & b, size_t n)
+{
+    const T c = b;
+    parallel_chunks(n, n, line_elements<T>(), [=](size_t i0, size_t i1) {
+        simd::broadcast<Op>(a + i0, c, i1 - i0);
+    });
+}
+
+/** `a[i] = b` for `i` in `[0, n)`
+ */
+template <typename T>
+void parallel_fill(T * a, const T & b, size_t n)
+{
+    const T c = b;
+    const bool stream = streaming<T>(n);
+    parallel_chunks(n, n, line_elements<T>(), [=](size_t i0, size_t i1) {
+        if (stream)
+            stream_fill(a + i0, c, i1 - i0);
+        else
+            std::fill(a + i0, a + i1, c);
+    });
+}
+
+/** `a[i] = static_cast<T>(b[i])` for `i` in `[0, n)`, which copies
+ * when the types match
+ */
+template <typename T, typename U>
+void parallel_cast(T * a, const U * b, size_t n)
+{
+    const bool stream = streaming<T>(n);
+    parallel_chunks(n, n, line_elements<T>(), [=](size_t i0, size_t i1) {
+        if (stream)
+            stream_cast(a + i0, b + i0, i1 - i0);
+        else
+            for (size_t i = i0; i < i1; ++i)
+                a[i] = static_cast<T>(b[i]);
+    });
+}
+
+/** Cast the leading `rows` by `cols` block of the column-major `b` into
+ * `a`
+ *
+ * When the columns are whole in both, the block is one contiguous
+ * range.  Otherwise the threads split the columns.
+ */
+template <typename T, typename U>
+void cast_columns(T * a, size_t lda, const U * b, size_t ldb, size_t rows,
+                  size_t cols)
+{
+    if (rows == lda && rows == ldb)
+    {
+        parallel_cast(a, b, rows * cols);
+        return;
+    }
+    parallel_chunks(cols, rows * cols, 1, [=](size_t j0, size_t j1) {
+        for (size_t j = j0; j < j1; ++j)
+            for (size_t i = 0; i < rows; ++i)
+                a[i + j * lda] = static_cast<T>(b[i + j * ldb]);
+    });
+}
+
+}; // end namespace detail
+
+}; // end namespace vecmat
+
+#endif
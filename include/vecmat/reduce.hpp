@@ -0,0 +1,404 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_REDUCE_H
+#define VECMAT_REDUCE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+
+#include "vecmat/batch.hpp"
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/transform.hpp"
+#include "vecmat/vector.hpp"
+
+namespace vecmat {
+
+/** # Reductions
+ *
+ * `sum`, `norm`, `min`, `max`, `argmin`, and `argmax` of the elements
+ * of the fixed and dynamic types, along with `normalize` and the
+ * `column_norms` of a matrix.  The norm of a matrix is its Frobenius
+ * norm.  The arg functions return the index of the first extreme
+ * element, counting down the columns for a matrix, or of the first NaN
+ * when there is one.  The extremes of an
+ * empty dynamic object throw `std::out_of_range`.
+ *
+ * The kernels keep several accumulators, so the order of the additions
+ * (and therefore the rounding) differs from a simple loop.
+ */
+namespace detail {
+
+template <typename T>
+T sum(const T * a, size_t n)
+{
+    return simd::fold<simd::plus>(a, n, static_cast<T>(0));
+}
+
+template <typename T>
+T norm(const T * a, size_t n)
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "norms need floating point values");
+    return std::sqrt(simd::inner(a, a, n));
+}
+
+template <typename T>
+T min(const T * a, size_t n, const char * func)
+{
+    if (n == 0)
+        throw std::out_of_range(func);
+    return simd::fold<simd::minimum>(a, n, a[0]);
+}
+
+template <typename T>
+T max(const T * a, size_t n, const char * func)
+{
+    if (n == 0)
+        throw std::out_of_range(func);
+    return simd::fold<simd::maximum>(a, n, a[0]);
+}
+
+/** Track the index of the first element no other `precedes` in one
+ * pass.  A NaN compares false with everything, so the first NaN wins
+ * outright instead.
+ */
+template <typename T, typename Compare>
+size_t arg_extreme(const T * a, size_t n, Compare precedes,
+                   const char * func)
+{
+    if (n == 0)
+        throw std::out_of_range(func);
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (a[i] != a[i])
+            return i;
+        if (precedes(a[i], a[k]))
+            k = i;
+    }
+    return k;
+}
+
+template <typename T>
+size_t argmin(const T * a, size_t n, const char * func)
+{
+    return arg_extreme(a, n, [](T x, T y) { return x < y; }, func);
+}
+
+template <typename T>
+size_t argmax(const T * a, size_t n, const char * func)
+{
+    return arg_extreme(a, n, [](T x, T y) { return y < x; }, func);
+}
+
+/** Write the norms of the `m` columns of length `n` at `a` to `b`
+ */
+template <typename T>
+void column_norms(const T * a, size_t n, size_t m, T * b)
+{
+    for (size_t j = 0; j < m; ++j)
+        b[j] = norm(a + j * n, n);
+}
+
+}; // end namespace detail
+
+/** ## Fixed size vectors
+ */
+template <size_t N, typename T>
+T sum(const vector<N, T> & a)
+{
+    return detail::sum(a.data, N);
+}
+template <size_t N, typename T>
+T norm(const vector<N, T> & a)
+{
+    return detail::norm(a.data, N);
+}
+template <size_t N, typename T>
+vector<N, T> normalize(vector<N, T> a)
+{
+    return a /= norm(a);
+}
+template <size_t N, typename T>
+T min(const vector<N, T> & a)
+{
+    return detail::min(a.data, N, __func__);
+}
+template <size_t N, typename T>
+T max(const vector<N, T> & a)
+{
+    return detail::max(a.data, N, __func__);
+}
+template <size_t N, typename T>
+size_t argmin(const vector<N, T> & a)
+{
+    return detail::argmin(a.data, N, __func__);
+}
+template <size_t N, typename T>
+size_t argmax(const vector<N, T> & a)
+{
+    return detail::argmax(a.data, N, __func__);
+}
+
+/** ## Fixed size matrices
+ */
+template <size_t N, size_t M, typename T>
+T sum(const matrix<N, M, T> & a)
+{
+    return detail::sum(a.data, N * M);
+}
+template <size_t N, size_t M, typename T>
+T norm(const matrix<N, M, T> & a)
+{
+    return detail::norm(a.data, N * M);
+}
+template <size_t N, size_t M, typename T>
+matrix<N, M, T> normalize(matrix<N, M, T> a)
+{
+    return a /= norm(a);
+}
+template <size_t N, size_t M, typename T>
+vector<M, T> column_norms(const matrix<N, M, T> & a)
+{
+    vector<M, T> b;
+    detail::column_norms(a.data, N, M, b.data);
+    return b;
+}
+template <size_t N, size_t M, typename T>
+T min(const matrix<N, M, T> & a)
+{
+    return detail::min(a.data, N * M, __func__);
+}
+template <size_t N, size_t M, typename T>
+T max(const matrix<N, M, T> & a)
+{
+    return detail::max(a.data, N * M, __func__);
+}
+template <size_t N, size_t M, typename T>
+size_t argmin(const matrix<N, M, T> & a)
+{
+    return detail::argmin(a.data, N * M, __func__);
+}
+template <size_t N, size_t M, typename T>
+size_t argmax(const matrix<N, M, T> & a)
+{
+    return detail::argmax(a.data, N * M, __func__);
+}
+
+/** ## Dynamic vectors
+ */
+template <typename T>
+T sum(const dvector<T> & a)
+{
+    return detail::sum(a.data(), a.size());
+}
+template <typename T>
+T norm(const dvector<T> & a)
+{
+    return detail::norm(a.data(), a.size());
+}
+template <typename T>
+dvector<T> normalize(dvector<T> a)
+{
+    a /= norm(a);
+    return a;
+}
+template <typename T>
+T min(const dvector<T> & a)
+{
+    return detail::min(a.data(), a.size(), __func__);
+}
+template <typename T>
+T max(const dvector<T> & a)
+{
+    return detail::max(a.data(), a.size(), __func__);
+}
+template <typename T>
+size_t argmin(const dvector<T> & a)
+{
+    return detail::argmin(a.data(), a.size(), __func__);
+}
+template <typename T>
+size_t argmax(const dvector<T> & a)
+{
+    return detail::argmax(a.data(), a.size(), __func__);
+}
+
+/** ## Dynamic matrices
+ */
+template <typename T>
+T sum(const dmatrix<T> & a)
+{
+    return detail::sum(a.data(), a.size());
+}
+template <typename T>
+T norm(const dmatrix<T> & a)
+{
+    return detail::norm(a.data(), a.size());
+}
+template <typename T>
+dmatrix<T> normalize(dmatrix<T> a)
+{
+    a /= norm(a);
+    return a;
+}
+template <typename T>
+dvector<T> column_norms(const dmatrix<T> & a)
+{
+    dvector<T> b(a.cols());
+    detail::column_norms(a.data(), a.rows(), a.cols(), b.data());
+    return b;
+}
+template <typename T>
+T min(const dmatrix<T> & a)
+{
+    return detail::min(a.data(), a.size(), __func__);
+}
+template <typename T>
+T max(const dmatrix<T> & a)
+{
+    return detail::max(a.data(), a.size(), __func__);
+}
+template <typename T>
+size_t argmin(const dmatrix<T> & a)
+{
+    return detail::argmin(a.data(), a.size(), __func__);
+}
+template <typename T>
+size_t argmax(const dmatrix<T> & a)
+{
+    return detail::argmax(a.data(), a.size(), __func__);
+}
+
+/** ## Batched normalization
+ *
+ * Normalize many vectors in place, a full pack of them at a time, with
+ * one square root and one division per pack.  Large batches are spread
+ * across the thread pool like the batched transforms.  A zero vector
+ * becomes NaN, as it would with `normalize`.
+ */
+namespace detail {
+
+/** Normalize `count` vectors held in the `N` lanes at `x`
+ *
+ * `count` is rounded up to a whole pack, which the lanes must hold.
+ */
+template <size_t N, typename T>
+void normalize_lanes(T * const * x, size_t count)
+{
+    typedef simd::pack<T> P;
+    const typename P::type one = P::set1(static_cast<T>(1));
+    for (size_t k = 0; k < count; k += P::width)
+    {
+        typename P::type p[N];
+        p[0] = P::loadu(x[0] + k);
+        typename P::type s = P::mul(p[0], p[0]);
+        for (size_t j = 1; j < N; ++j)
+        {
+            p[j] = P::loadu(x[j] + k);
+            s = P::fmadd(p[j], p[j], s);
+        }
+        const typename P::type r = P::div(one, P::sqrt(s));
+        for (size_t j = 0; j < N; ++j)
+            P::storeu(x[j] + k, P::mul(p[j], r));
+    }
+}
+
+/** The array form gathers a pack of vectors into lanes on the stack
+ */
+template <size_t N, typename T>
+void normalize_points(vector<N, T> * a, size_t count)
+{
+    typedef simd::pack<T> P;
+    T buffer[N][P::width];
+    T * lanes[N];
+    for (size_t j = 0; j < N; ++j)
+        lanes[j] = buffer[j];
+
+    size_t i = 0;
+    for (; i + P::width <= count; i += P::width)
+    {
+        for (size_t k = 0; k < P::width; ++k)
+            for (size_t j = 0; j < N; ++j)
+                buffer[j][k] = a[i + k].data[j];
+        normalize_lanes<N>(lanes, P::width);
+        for (size_t k = 0; k < P::width; ++k)
+            for (size_t j = 0; j < N; ++j)
+                a[i + k].data[j] = buffer[j][k];
+    }
+    for (; i < count; ++i)
+    {
+        T * p = a[i].data;
+        T s = 0;
+        for (size_t j = 0; j < N; ++j)
+            s += p[j] * p[j];
+        const T r = static_cast<T>(1) / std::sqrt(s);
+        for (size_t j = 0; j < N; ++j)
+            p[j] *= r;
+    }
+}
+
+}; // end namespace detail
+
+template <size_t N, typename T>
+void normalize(vector<N, T> * a, size_t count)
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "normalize needs floating point values");
+    detail::transform_chunks(count, simd::pack<T>::width,
+                             [=](size_t i0, size_t i1) {
+        detail::normalize_points(a + i0, i1 - i0);
+    });
+}
+
+template <size_t N, typename T>
+void normalize(vector_batch<N, T> & a)
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "normalize needs floating point values");
+    const size_t align = 64 / sizeof(T);
+    detail::transform_chunks(a.lane_stride(), align,
+                             [&](size_t i0, size_t i1) {
+        T * x[N];
+        for (size_t k = 0; k < N; ++k)
+            x[k] = a.lane(k) + i0;
+        detail::normalize_lanes<N>(x, i1 - i0);
+    });
+}
+
+}; // end namespace vecmat
+
+#endif
@@ -0,0 +1,1071 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_SIMD_H
+#define VECMAT_SIMD_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+/** ## Instruction set detection
+ *
+ * We only rely on what the compiler tells us it is allowed to emit.
+ * Building with `-mavx2` (or `/arch:AVX2`) and friends selects the
+ * wider kernels.  Every x86-64 target has at least SSE2.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECMAT_SSE2 1
+#endif
+#if defined(__AVX__)
+#define VECMAT_AVX 1
+#endif
+#if defined(__AVX2__)
+#define VECMAT_AVX2 1
+#endif
+#if defined(__AVX512F__)
+#define VECMAT_AVX512 1
+#endif
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define VECMAT_FMA 1
+#endif
+
+#if defined(VECMAT_SSE2)
+#include <immintrin.h>
+#endif
+
+/** ## Runtime dispatch
+ *
+ * Defining `VECMAT_DISPATCH` also compiles AVX2 and AVX-512 versions of
+ * the streaming kernels, whatever the compiler flags, and picks the
+ * best one the processor supports when the program runs (see
+ * `dispatch.hpp`).  The wider packs are then defined inside target
+ * regions so that only the kernels built for them use the instructions.
+ * This needs GCC on x86-64; elsewhere the macro has no effect.  Define
+ * it the same way in every translation unit of a program.
+ */
+#if defined(VECMAT_DISPATCH) && defined(__x86_64__) && \
+    defined(__GNUC__) && ! defined(__clang__)
+#define VECMAT_DISPATCH_X86 1
+#define VECMAT_TARGET_AVX2_BEGIN \
+    _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma\")")
+#define VECMAT_TARGET_AVX512_BEGIN \
+    _Pragma("GCC push_options") \
+    _Pragma("GCC target(\"avx512f,avx2,fma\")")
+#define VECMAT_TARGET_END _Pragma("GCC pop_options")
+#endif
+
+#if defined(VECMAT_FMA) || \
+    (defined(VECMAT_DISPATCH_X86) && ! defined(VECMAT_AVX))
+#define VECMAT_AVX_FMA 1
+#endif
+
+/** ## Compile time evaluation
+ *
+ * With C++14 relaxed `constexpr` the fixed size types can be built and
+ * combined at compile time, so tables of transforms end up in read only
+ * data instead of being computed during static initialization.  The
+ * intrinsics are never `constexpr`, so the kernels that use them ask
+ * `VECMAT_CONSTANT_EVALUATED()` and take the plain loop instead.
+ * Without a way to ask, or before C++14, `VECMAT_CONSTEXPR` is empty
+ * and `VECMAT_HAS_CONSTEXPR` is zero.
+ */
+#if defined(__cpp_lib_is_constant_evaluated)
+#define VECMAT_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define VECMAT_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#elif (defined(__GNUC__) && __GNUC__ >= 9) || \
+    (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define VECMAT_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+#if defined(VECMAT_CONSTANT_EVALUATED) && \
+    (__cplusplus >= 201402L || \
+     (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L))
+#define VECMAT_CONSTEXPR constexpr
+#define VECMAT_HAS_CONSTEXPR 1
+#else
+#undef VECMAT_CONSTANT_EVALUATED
+#define VECMAT_CONSTANT_EVALUATED() false
+#define VECMAT_CONSTEXPR
+#define VECMAT_HAS_CONSTEXPR 0
+#endif
+
+namespace vecmat {
+
+namespace simd {
+
+/** ## Register packs
+ *
+ * A pack wraps a machine register holding `width` elements of type `T`
+ * along with the handful of operations the kernels need.  The scalar
+ * pack is the portable fallback and also handles the tail of every
+ * loop that does not fill a full register.  `load` and `store` need
+ * the address aligned to the width of the register, `loadu` and
+ * `storeu` do not.  `stream` is an aligned store that bypasses the
+ * caches where the processor can.  The `double` packs can also `widen`
+ * as many floats as they hold while loading them.
+ */
+template <typename T>
+struct scalar {
+    typedef T value_type;
+    typedef T type;
+    static const size_t width = 1;
+
+    static type loadu(const T * p) { return *p; }
+    static void storeu(T * p, type a) { *p = a; }
+    static type load(const T * p) { return *p; }
+    static void store(T * p, type a) { *p = a; }
+    static void stream(T * p, type a) { *p = a; }
+    static type set1(T a) { return a; }
+    static type widen(const float * p) { return *p; }
+
+    static VECMAT_CONSTEXPR type add(type a, type b) { return a + b; }
+    static VECMAT_CONSTEXPR type sub(type a, type b) { return a - b; }
+    static VECMAT_CONSTEXPR type mul(type a, type b) { return a * b; }
+    static VECMAT_CONSTEXPR type div(type a, type b) { return a / b; }
+    static VECMAT_CONSTEXPR type min(type a, type b) { return a < b ? a : b; }
+    static VECMAT_CONSTEXPR type max(type a, type b) { return a > b ? a : b; }
+    static type sqrt(type a) { return std::sqrt(a); }
+    static type fmadd(type a, type b, type c) { return a * b + c; }
+};
+
+template <typename T> struct sse;
+template <typename T> struct avx;
+template <typename T> struct avx512;
+
+#if defined(VECMAT_SSE2)
+template <>
+struct sse<float> {
+    typedef float value_type;
+    typedef __m128 type;
+    static const size_t width = 4;
+
+    static type loadu(const float * p) { return _mm_loadu_ps(p); }
+    static void storeu(float * p, type a) { _mm_storeu_ps(p, a); }
+    static type load(const float * p) { return _mm_load_ps(p); }
+    static void store(float * p, type a) { _mm_store_ps(p, a); }
+    static void stream(float * p, type a) { _mm_stream_ps(p, a); }
+    static type set1(float a) { return _mm_set1_ps(a); }
+
+    static type add(type a, type b) { return _mm_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+    static type div(type a, type b) { return _mm_div_ps(a, b); }
+    static type min(type a, type b) { return _mm_min_ps(a, b); }
+    static type max(type a, type b) { return _mm_max_ps(a, b); }
+    static type sqrt(type a) { return _mm_sqrt_ps(a); }
+    static type fmadd(type a, type b, type c)
+    {
+#if defined(VECMAT_FMA)
+        return _mm_fmadd_ps(a, b, c);
+#else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+    }
+};
+
+template <>
+struct sse<double> {
+    typedef double value_type;
+    typedef __m128d type;
+    static const size_t width = 2;
+
+    static type loadu(const double * p) { return _mm_loadu_pd(p); }
+    static void storeu(double * p, type a) { _mm_storeu_pd(p, a); }
+    static type load(const double * p) { return _mm_load_pd(p); }
+    static void store(double * p, type a) { _mm_store_pd(p, a); }
+    static void stream(double * p, type a) { _mm_stream_pd(p, a); }
+    static type set1(double a) { return _mm_set1_pd(a); }
+    static type widen(const float * p)
+    {
+        return _mm_cvtps_pd(_mm_loadl_pi(_mm_setzero_ps(),
+                                         reinterpret_cast<const __m64 *>(p)));
+    }
+
+    static type add(type a, type b) { return _mm_add_pd(a, b); }
+    static type sub(type a, type b) { return _mm_sub_pd(a, b); }
+    static type mul(type a, type b) { return _mm_mul_pd(a, b); }
+    static type div(type a, type b) { return _mm_div_pd(a, b); }
+    static type min(type a, type b) { return _mm_min_pd(a, b); }
+    static type max(type a, type b) { return _mm_max_pd(a, b); }
+    static type sqrt(type a) { return _mm_sqrt_pd(a); }
+    static type fmadd(type a, type b, type c)
+    {
+#if defined(VECMAT_FMA)
+        return _mm_fmadd_pd(a, b, c);
+#else
+        return _mm_add_pd(_mm_mul_pd(a, b), c);
+#endif
+    }
+};
+
+/** There is no packed integer division on x86, so the `int32_t` packs
+ * do not provide `div`.  See `kernel_pack` below.
+ */
+template <>
+struct sse<int32_t> {
+    typedef int32_t value_type;
+    typedef __m128i type;
+    static const size_t width = 4;
+
+    static type loadu(const int32_t * p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    }
+    static void storeu(int32_t * p, type a)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), a);
+    }
+    static type load(const int32_t * p)
+    {
+        return _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+    }
+    static void store(int32_t * p, type a)
+    {
+        _mm_store_si128(reinterpret_cast<__m128i *>(p), a);
+    }
+    static void stream(int32_t * p, type a)
+    {
+        _mm_stream_si128(reinterpret_cast<__m128i *>(p), a);
+    }
+    static type set1(int32_t a) { return _mm_set1_epi32(a); }
+
+    static type add(type a, type b) { return _mm_add_epi32(a, b); }
+    static type sub(type a, type b) { return _mm_sub_epi32(a, b); }
+    static type mul(type a, type b)
+    {
+#if defined(__SSE4_1__)
+        return _mm_mullo_epi32(a, b);
+#else
+        // SSE2 only multiplies the even lanes, so do it twice
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4),
+                                    _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(
+            _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+    static type min(type a, type b)
+    {
+#if defined(__SSE4_1__)
+        return _mm_min_epi32(a, b);
+#else
+        const __m128i m = _mm_cmplt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+#endif
+    }
+    static type max(type a, type b)
+    {
+#if defined(__SSE4_1__)
+        return _mm_max_epi32(a, b);
+#else
+        const __m128i m = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+#endif
+    }
+    static type fmadd(type a, type b, type c) { return add(mul(a, b), c); }
+};
+#endif
+
+#if defined(VECMAT_AVX) || defined(VECMAT_DISPATCH_X86)
+#if ! defined(VECMAT_AVX)
+VECMAT_TARGET_AVX2_BEGIN
+#endif
+template <>
+struct avx<float> {
+    typedef float value_type;
+    typedef __m256 type;
+    static const size_t width = 8;
+
+    static type loadu(const float * p) { return _mm256_loadu_ps(p); }
+    static void storeu(float * p, type a) { _mm256_storeu_ps(p, a); }
+    static type load(const float * p) { return _mm256_load_ps(p); }
+    static void store(float * p, type a) { _mm256_store_ps(p, a); }
+    static void stream(float * p, type a) { _mm256_stream_ps(p, a); }
+    static type set1(float a) { return _mm256_set1_ps(a); }
+
+    static type add(type a, type b) { return _mm256_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+    static type div(type a, type b) { return _mm256_div_ps(a, b); }
+    static type min(type a, type b) { return _mm256_min_ps(a, b); }
+    static type max(type a, type b) { return _mm256_max_ps(a, b); }
+    static type sqrt(type a) { return _mm256_sqrt_ps(a); }
+    static type fmadd(type a, type b, type c)
+    {
+#if defined(VECMAT_AVX_FMA)
+        return _mm256_fmadd_ps(a, b, c);
+#else
+        return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+    }
+};
+
+template <>
+struct avx<double> {
+    typedef double value_type;
+    typedef __m256d type;
+    static const size_t width = 4;
+
+    static type loadu(const double * p) { return _mm256_loadu_pd(p); }
+    static void storeu(double * p, type a) { _mm256_storeu_pd(p, a); }
+    static type load(const double * p) { return _mm256_load_pd(p); }
+    static void store(double * p, type a) { _mm256_store_pd(p, a); }
+    static void stream(double * p, type a) { _mm256_stream_pd(p, a); }
+    static type set1(double a) { return _mm256_set1_pd(a); }
+    static type widen(const float * p)
+    {
+        return _mm256_cvtps_pd(_mm_loadu_ps(p));
+    }
+
+    static type add(type a, type b) { return _mm256_add_pd(a, b); }
+    static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+    static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+    static type div(type a, type b) { return _mm256_div_pd(a, b); }
+    static type min(type a, type b) { return _mm256_min_pd(a, b); }
+    static type max(type a, type b) { return _mm256_max_pd(a, b); }
+    static type sqrt(type a) { return _mm256_sqrt_pd(a); }
+    static type fmadd(type a, type b, type c)
+    {
+#if defined(VECMAT_AVX_FMA)
+        return _mm256_fmadd_pd(a, b, c);
+#else
+        return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+    }
+};
+#if ! defined(VECMAT_AVX)
+VECMAT_TARGET_END
+#endif
+#endif
+
+#if defined(VECMAT_AVX2)
+template <>
+struct avx<int32_t> {
+    typedef int32_t value_type;
+    typedef __m256i type;
+    static const size_t width = 8;
+
+    static type loadu(const int32_t * p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+    static void storeu(int32_t * p, type a)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a);
+    }
+    static type load(const int32_t * p)
+    {
+        return _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+    }
+    static void store(int32_t * p, type a)
+    {
+        _mm256_store_si256(reinterpret_cast<__m256i *>(p), a);
+    }
+    static void stream(int32_t * p, type a)
+    {
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(p), a);
+    }
+    static type set1(int32_t a) { return _mm256_set1_epi32(a); }
+
+    static type add(type a, type b) { return _mm256_add_epi32(a, b); }
+    static type sub(type a, type b) { return _mm256_sub_epi32(a, b); }
+    static type mul(type a, type b) { return _mm256_mullo_epi32(a, b); }
+    static type min(type a, type b) { return _mm256_min_epi32(a, b); }
+    static type max(type a, type b) { return _mm256_max_epi32(a, b); }
+    static type fmadd(type a, type b, type c) { return add(mul(a, b), c); }
+};
+#endif
+
+#if defined(VECMAT_AVX512) || defined(VECMAT_DISPATCH_X86)
+#if ! defined(VECMAT_AVX512)
+VECMAT_TARGET_AVX512_BEGIN
+#endif
+/** A few of the AVX-512 intrinsics are written with their masked forms
+ * and a full mask.  It is the same instruction, but GCC 12 mistakes the
+ * undefined register inside the plain forms for an uninitialized
+ * variable once they are inlined.
+ */
+template <>
+struct avx512<float> {
+    typedef float value_type;
+    typedef __m512 type;
+    static const size_t width = 16;
+
+    static type loadu(const float * p) { return _mm512_loadu_ps(p); }
+    static void storeu(float * p, type a) { _mm512_storeu_ps(p, a); }
+    static type load(const float * p) { return _mm512_load_ps(p); }
+    static void store(float * p, type a) { _mm512_store_ps(p, a); }
+    static void stream(float * p, type a) { _mm512_stream_ps(p, a); }
+    static type set1(float a) { return _mm512_set1_ps(a); }
+
+    static type add(type a, type b) { return _mm512_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm512_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+    static type div(type a, type b) { return _mm512_div_ps(a, b); }
+    static type min(type a, type b)
+    {
+        return _mm512_mask_min_ps(a, 0xFFFF, a, b);
+    }
+    static type max(type a, type b)
+    {
+        return _mm512_mask_max_ps(a, 0xFFFF, a, b);
+    }
+    static type sqrt(type a) { return _mm512_mask_sqrt_ps(a, 0xFFFF, a); }
+    static type fmadd(type a, type b, type c)
+    {
+        return _mm512_fmadd_ps(a, b, c);
+    }
+};
+
+template <>
+struct avx512<double> {
+    typedef double value_type;
+    typedef __m512d type;
+    static const size_t width = 8;
+
+    static type loadu(const double * p) { return _mm512_loadu_pd(p); }
+    static void storeu(double * p, type a) { _mm512_storeu_pd(p, a); }
+    static type load(const double * p) { return _mm512_load_pd(p); }
+    static void store(double * p, type a) { _mm512_store_pd(p, a); }
+    static void stream(double * p, type a) { _mm512_stream_pd(p, a); }
+    static type set1(double a) { return _mm512_set1_pd(a); }
+    static type widen(const float * p)
+    {
+        return _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(p));
+    }
+
+    static type add(type a, type b) { return _mm512_add_pd(a, b); }
+    static type sub(type a, type b) { return _mm512_sub_pd(a, b); }
+    static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+    static type div(type a, type b) { return _mm512_div_pd(a, b); }
+    static type min(type a, type b)
+    {
+        return _mm512_mask_min_pd(a, 0xFF, a, b);
+    }
+    static type max(type a, type b)
+    {
+        return _mm512_mask_max_pd(a, 0xFF, a, b);
+    }
+    static type sqrt(type a) { return _mm512_mask_sqrt_pd(a, 0xFF, a); }
+    static type fmadd(type a, type b, type c)
+    {
+        return _mm512_fmadd_pd(a, b, c);
+    }
+};
+
+template <>
+struct avx512<int32_t> {
+    typedef int32_t value_type;
+    typedef __m512i type;
+    static const size_t width = 16;
+
+    static type loadu(const int32_t * p) { return _mm512_loadu_si512(p); }
+    static void storeu(int32_t * p, type a) { _mm512_storeu_si512(p, a); }
+    static type load(const int32_t * p) { return _mm512_load_si512(p); }
+    static void store(int32_t * p, type a) { _mm512_store_si512(p, a); }
+    static void stream(int32_t * p, type a)
+    {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(p), a);
+    }
+    static type set1(int32_t a) { return _mm512_set1_epi32(a); }
+
+    static type add(type a, type b) { return _mm512_add_epi32(a, b); }
+    static type sub(type a, type b) { return _mm512_sub_epi32(a, b); }
+    static type mul(type a, type b) { return _mm512_mullo_epi32(a, b); }
+    static type min(type a, type b)
+    {
+        return _mm512_mask_min_epi32(a, 0xFFFF, a, b);
+    }
+    static type max(type a, type b)
+    {
+        return _mm512_mask_max_epi32(a, 0xFFFF, a, b);
+    }
+    static type fmadd(type a, type b, type c) { return add(mul(a, b), c); }
+};
+#if ! defined(VECMAT_AVX512)
+VECMAT_TARGET_END
+#endif
+#endif
+
+/** ### Paired packs
+ *
+ * Two registers treated as one pack of twice the width.  This lets the
+ * fixed-width kernels below run on narrower instruction sets (and on
+ * the scalar pack) without a separate implementation.
+ */
+template <typename P>
+struct twice {
+    typedef typename P::value_type value_type;
+    struct type {
+        typename P::type lo;
+        typename P::type hi;
+    };
+    static const size_t width = 2 * P::width;
+
+    static type loadu(const value_type * p)
+    {
+        type a = {P::loadu(p), P::loadu(p + P::width)};
+        return a;
+    }
+    static void storeu(value_type * p, type a)
+    {
+        P::storeu(p, a.lo);
+        P::storeu(p + P::width, a.hi);
+    }
+    static type load(const value_type * p)
+    {
+        type a = {P::load(p), P::load(p + P::width)};
+        return a;
+    }
+    static void store(value_type * p, type a)
+    {
+        P::store(p, a.lo);
+        P::store(p + P::width, a.hi);
+    }
+    static void stream(value_type * p, type a)
+    {
+        P::stream(p, a.lo);
+        P::stream(p + P::width, a.hi);
+    }
+    static type set1(value_type a)
+    {
+        type b = {P::set1(a), P::set1(a)};
+        return b;
+    }
+    static type widen(const float * p)
+    {
+        type a = {P::widen(p), P::widen(p + P::width)};
+        return a;
+    }
+
+    static type add(type a, type b)
+    {
+        type c = {P::add(a.lo, b.lo), P::add(a.hi, b.hi)};
+        return c;
+    }
+    static type sub(type a, type b)
+    {
+        type c = {P::sub(a.lo, b.lo), P::sub(a.hi, b.hi)};
+        return c;
+    }
+    static type mul(type a, type b)
+    {
+        type c = {P::mul(a.lo, b.lo), P::mul(a.hi, b.hi)};
+        return c;
+    }
+    static type div(type a, type b)
+    {
+        type c = {P::div(a.lo, b.lo), P::div(a.hi, b.hi)};
+        return c;
+    }
+    static type min(type a, type b)
+    {
+        type c = {P::min(a.lo, b.lo), P::min(a.hi, b.hi)};
+        return c;
+    }
+    static type max(type a, type b)
+    {
+        type c = {P::max(a.lo, b.lo), P::max(a.hi, b.hi)};
+        return c;
+    }
+    static type sqrt(type a)
+    {
+        type b = {P::sqrt(a.lo), P::sqrt(a.hi)};
+        return b;
+    }
+    static type fmadd(type a, type b, type c)
+    {
+        type d = {P::fmadd(a.lo, b.lo, c.lo), P::fmadd(a.hi, b.hi, c.hi)};
+        return d;
+    }
+};
+
+/** ### Native pack selection
+ *
+ * The `pack` is the widest register available for the type on the
+ * target.  Types we do not have kernels for fall back to the scalar
+ * pack.
+ */
+template <typename T>
+struct pack : scalar<T> {};
+
+#if defined(VECMAT_AVX512)
+template <> struct pack<float> : avx512<float> {};
+template <> struct pack<double> : avx512<double> {};
+#elif defined(VECMAT_AVX)
+template <> struct pack<float> : avx<float> {};
+template <> struct pack<double> : avx<double> {};
+#elif defined(VECMAT_SSE2)
+template <> struct pack<float> : sse<float> {};
+template <> struct pack<double> : sse<double> {};
+#endif
+
+#if defined(VECMAT_AVX512)
+template <> struct pack<int32_t> : avx512<int32_t> {};
+#elif defined(VECMAT_AVX2)
+template <> struct pack<int32_t> : avx<int32_t> {};
+#elif defined(VECMAT_SSE2)
+template <> struct pack<int32_t> : sse<int32_t> {};
+#endif
+
+/** ## Element-wise operations
+ *
+ * The operations are expressed against a pack so the same definition
+ * drives both the vector body and the scalar tail of a loop.
+ */
+template <typename P>
+struct plus {
+    static VECMAT_CONSTEXPR typename P::type
+    apply(typename P::type a, typename P::type b)
+    {
+        return P::add(a, b);
+    }
+};
+template <typename P>
+struct minus {
+    static VECMAT_CONSTEXPR typename P::type
+    apply(typename P::type a, typename P::type b)
+    {
+        return P::sub(a, b);
+    }
+};
+template <typename P>
+struct multiplies {
+    static VECMAT_CONSTEXPR typename P::type
+    apply(typename P::type a, typename P::type b)
+    {
+        return P::mul(a, b);
+    }
+};
+template <typename P>
+struct divides {
+    static VECMAT_CONSTEXPR typename P::type
+    apply(typename P::type a, typename P::type b)
+    {
+        return P::div(a, b);
+    }
+};
+template <typename P>
+struct minimum {
+    static VECMAT_CONSTEXPR typename P::type
+    apply(typename P::type a, typename P::type b)
+    {
+        return P::min(a, b);
+    }
+};
+template <typename P>
+struct maximum {
+    static VECMAT_CONSTEXPR typename P::type
+    apply(typename P::type a, typename P::type b)
+    {
+        return P::max(a, b);
+    }
+};
+
+/** The pack used for a given operation
+ *
+ * This is the native pack unless the instruction set cannot perform
+ * the operation on the type.
+ */
+template <template <typename> class Op, typename T>
+struct kernel_pack {
+    typedef pack<T> type;
+};
+template <>
+struct kernel_pack<divides, int32_t> {
+    typedef scalar<int32_t> type;
+};
+
+/** ### Four element packs
+ *
+ * The 4x4 kernels want exactly one column per register.
+ */
+template <typename T>
+struct quad : twice<twice<scalar<T> > > {};
+
+#if defined(VECMAT_SSE2)
+template <> struct quad<float> : sse<float> {};
+#endif
+#if defined(VECMAT_AVX)
+template <> struct quad<double> : avx<double> {};
+#elif defined(VECMAT_SSE2)
+template <> struct quad<double> : twice<sse<double> > {};
+#endif
+
+#if defined(VECMAT_DISPATCH_X86)
+/** The run time selected kernels
+ *
+ * Each returns false, leaving the work to the caller, when there is no
+ * better kernel for the type, size, and processor.
+ */
+namespace dispatch {
+template <template <typename> class Op, typename T>
+bool transform(T * a, const T * b, size_t n);
+template <template <typename> class Op, typename T>
+bool broadcast(T * a, const T & b, size_t n);
+template <typename T>
+bool inner(const T * a, const T * b, size_t n, T & r);
+template <typename T>
+bool mat4_columns(const T * a, const T * b, T * c, size_t count);
+}; // end namespace dispatch
+#endif
+
+/** ## Kernels
+ *
+ * Apply `a[i] = a[i] op b[i]` over `n` elements.  The data need not be
+ * aligned.
+ */
+template <template <typename> class Op, typename T>
+void transform(T * a, const T * b, size_t n)
+{
+#if defined(VECMAT_DISPATCH_X86)
+    if (dispatch::transform<Op>(a, b, n))
+        return;
+#endif
+    typedef typename kernel_pack<Op, T>::type P;
+    typedef scalar<T> S;
+
+    const size_t m = n - n % P::width;
+    size_t i = 0;
+    for (; i < m; i += P::width)
+        P::storeu(a + i, Op<P>::apply(P::loadu(a + i), P::loadu(b + i)));
+    for (; i < n; ++i)
+        a[i] = Op<S>::apply(a[i], b[i]);
+}
+
+/** Apply `a[i] = a[i] op b` over `n` elements
+ */
+template <template <typename> class Op, typename T>
+void broadcast(T * a, const T & b, size_t n)
+{
+#if defined(VECMAT_DISPATCH_X86)
+    if (dispatch::broadcast<Op>(a, b, n))
+        return;
+#endif
+    typedef typename kernel_pack<Op, T>::type P;
+    typedef scalar<T> S;
+
+    const typename P::type s = P::set1(b);
+    const size_t m = n - n % P::width;
+    size_t i = 0;
+    for (; i < m; i += P::width)
+        P::storeu(a + i, Op<P>::apply(P::loadu(a + i), s));
+    for (; i < n; ++i)
+        a[i] = Op<S>::apply(a[i], b);
+}
+
+/** Set `a[i] = b` over `n` elements
+ */
+template <typename T>
+void fill(T * a, const T & b, size_t n)
+{
+    typedef pack<T> P;
+
+    const typename P::type s = P::set1(b);
+    const size_t m = n - n % P::width;
+    size_t i = 0;
+    for (; i < m; i += P::width)
+        P::storeu(a + i, s);
+    for (; i < n; ++i)
+        a[i] = b;
+}
+
+/** Set `a[i] = -b[i]` over `n` elements.  Subtracting from negative
+ * zero flips the sign of a zero just as negation does.
+ */
+template <typename T>
+void negate(T * a, const T * b, size_t n)
+{
+    typedef pack<T> P;
+
+    const typename P::type z = P::set1(-static_cast<T>(0));
+    const size_t m = n - n % P::width;
+    size_t i = 0;
+    for (; i < m; i += P::width)
+        P::storeu(a + i, P::sub(z, P::loadu(b + i)));
+    for (; i < n; ++i)
+        a[i] = -b[i];
+}
+
+/** ## Reductions
+ *
+ * Combine the `n` elements at `a` with `Op`, starting from `init`.
+ * Four independent accumulators keep the pipeline full rather than
+ * waiting on the latency of each operation.  They are combined, and
+ * then the lanes of the result, at the end, so the order of the
+ * operations depends on the pack width.  Like the instructions, the
+ * `minimum` and `maximum` of a NaN is unspecified.
+ */
+template <template <typename> class Op, typename T>
+T fold(const T * a, size_t n, T init)
+{
+    typedef typename kernel_pack<Op, T>::type P;
+    typedef scalar<T> S;
+
+    typename P::type r0 = P::set1(init);
+    typename P::type r1 = r0;
+    typename P::type r2 = r0;
+    typename P::type r3 = r0;
+    const size_t m = n - n % (4 * P::width);
+    size_t i = 0;
+    for (; i < m; i += 4 * P::width)
+    {
+        r0 = Op<P>::apply(r0, P::loadu(a + i));
+        r1 = Op<P>::apply(r1, P::loadu(a + i + P::width));
+        r2 = Op<P>::apply(r2, P::loadu(a + i + 2 * P::width));
+        r3 = Op<P>::apply(r3, P::loadu(a + i + 3 * P::width));
+    }
+    r0 = Op<P>::apply(Op<P>::apply(r0, r1), Op<P>::apply(r2, r3));
+    for (; i + P::width <= n; i += P::width)
+        r0 = Op<P>::apply(r0, P::loadu(a + i));
+    T lanes[P::width];
+    P::storeu(lanes, r0);
+    T r = lanes[0];
+    for (size_t k = 1; k < P::width; ++k)
+        r = Op<S>::apply(r, lanes[k]);
+    for (; i < n; ++i)
+        r = Op<S>::apply(r, a[i]);
+    return r;
+}
+
+/** The inner product of `n` elements
+ *
+ * This uses the same four accumulators as `fold`.
+ */
+template <typename T>
+T inner(const T * a, const T * b, size_t n)
+{
+#if defined(VECMAT_DISPATCH_X86)
+    T d;
+    if (dispatch::inner(a, b, n, d))
+        return d;
+#endif
+    typedef pack<T> P;
+
+    typename P::type s0 = P::set1(T(0));
+    typename P::type s1 = s0;
+    typename P::type s2 = s0;
+    typename P::type s3 = s0;
+    const size_t m = n - n % (4 * P::width);
+    size_t i = 0;
+    for (; i < m; i += 4 * P::width)
+    {
+        const T * x = a + i;
+        const T * y = b + i;
+        s0 = P::fmadd(P::loadu(x), P::loadu(y), s0);
+        s1 = P::fmadd(P::loadu(x + P::width), P::loadu(y + P::width), s1);
+        s2 = P::fmadd(P::loadu(x + 2 * P::width),
+                      P::loadu(y + 2 * P::width), s2);
+        s3 = P::fmadd(P::loadu(x + 3 * P::width),
+                      P::loadu(y + 3 * P::width), s3);
+    }
+    s0 = P::add(P::add(s0, s1), P::add(s2, s3));
+    for (; i + P::width <= n; i += P::width)
+        s0 = P::fmadd(P::loadu(a + i), P::loadu(b + i), s0);
+    T lanes[P::width];
+    P::storeu(lanes, s0);
+    T r = 0;
+    for (size_t k = 0; k < P::width; ++k)
+        r += lanes[k];
+    for (; i < n; ++i)
+        r += a[i] * b[i];
+    return r;
+}
+
+/** ## Level 1 kernels
+ *
+ * The BLAS style updates make a single pass over memory.  The packs
+ * fuse the multiply and add wherever the target has the instruction,
+ * and the scalar tail matches them: `fused` only calls `std::fma` when
+ * the library says it is as fast as the separate operations.
+ */
+template <typename T>
+T fused(T a, T b, T c)
+{
+    return a * b + c;
+}
+#if defined(FP_FAST_FMAF)
+inline float fused(float a, float b, float c)
+{
+    return std::fma(a, b, c);
+}
+#endif
+#if defined(FP_FAST_FMA)
+inline double fused(double a, double b, double c)
+{
+    return std::fma(a, b, c);
+}
+#endif
+
+/** Compute `y[i] = a x[i] + y[i]` over `n` elements
+ */
+template <typename T>
+void axpy(size_t n, const T & a, const T * x, T * y)
+{
+    typedef pack<T> P;
+
+    const typename P::type s = P::set1(a);
+    const size_t m = n - n % P::width;
+    size_t i = 0;
+    for (; i < m; i += P::width)
+        P::storeu(y + i, P::fmadd(s, P::loadu(x + i), P::loadu(y + i)));
+    for (; i < n; ++i)
+        y[i] = fused(a, x[i], y[i]);
+}
+
+/** Compute `y[i] = a x[i] + b y[i]` over `n` elements
+ */
+template <typename T>
+void axpby(size_t n, const T & a, const T * x, const T & b, T * y)
+{
+    typedef pack<T> P;
+
+    const typename P::type s = P::set1(a);
+    const typename P::type t = P::set1(b);
+    const size_t m = n - n % P::width;
+    size_t i = 0;
+    for (; i < m; i += P::width)
+        P::storeu(y + i, P::fmadd(s, P::loadu(x + i),
+                                  P::mul(t, P::loadu(y + i))));
+    for (; i < n; ++i)
+        y[i] = fused(a, x[i], b * y[i]);
+}
+
+/** Compute `d[i] = a[i] b[i] + c[i]` over `n` elements
+ *
+ * `d` may be any of the inputs.
+ */
+template <typename T>
+void fma(size_t n, const T * a, const T * b, const T * c, T * d)
+{
+    typedef pack<T> P;
+
+    const size_t m = n - n % P::width;
+    size_t i = 0;
+    for (; i < m; i += P::width)
+        P::storeu(d + i, P::fmadd(P::loadu(a + i), P::loadu(b + i),
+                                  P::loadu(c + i)));
+    for (; i < n; ++i)
+        d[i] = fused(a[i], b[i], c[i]);
+}
+
+/** ## 4x4 kernels
+ *
+ * Column-major 4x4 matrices map exactly onto 4-wide registers.  Each
+ * output column is the columns of `a` scaled by the four entries of
+ * the matching column of `b`, so we keep `a` in registers and
+ * broadcast the entries of `b`.  This computes `count` columns which
+ * covers matrix products (4), matrix-vector products (1), and batches
+ * of homogeneous points.  The output must not alias the inputs.
+ */
+template <typename T>
+void mat4_columns(const T * a, const T * b, T * c, size_t count)
+{
+#if defined(VECMAT_DISPATCH_X86)
+    if (dispatch::mat4_columns(a, b, c, count))
+        return;
+#endif
+    typedef quad<T> P;
+    const typename P::type a0 = P::loadu(a);
+    const typename P::type a1 = P::loadu(a + 4);
+    const typename P::type a2 = P::loadu(a + 8);
+    const typename P::type a3 = P::loadu(a + 12);
+    for (size_t j = 0; j < count; ++j, b += 4, c += 4)
+    {
+        typename P::type r = P::mul(a0, P::set1(b[0]));
+        r = P::fmadd(a1, P::set1(b[1]), r);
+        r = P::fmadd(a2, P::set1(b[2]), r);
+        r = P::fmadd(a3, P::set1(b[3]), r);
+        P::storeu(c, r);
+    }
+}
+
+/** Write the transpose of the 4x4 block at `a` to `b`
+ *
+ * Both blocks are column-major with leading dimensions `lda` and `ldb`
+ * and must not overlap.  The 4-wide packs use the usual register
+ * shuffles; everything else goes element by element.
+ */
+template <typename T>
+void transpose4(const T * a, size_t lda, T * b, size_t ldb)
+{
+    for (size_t j = 0; j < 4; ++j)
+        for (size_t i = 0; i < 4; ++i)
+            b[j + i * ldb] = a[i + j * lda];
+}
+
+#if defined(VECMAT_SSE2)
+inline void transpose4(const float * a, size_t lda, float * b, size_t ldb)
+{
+    __m128 r0 = _mm_loadu_ps(a);
+    __m128 r1 = _mm_loadu_ps(a + lda);
+    __m128 r2 = _mm_loadu_ps(a + 2 * lda);
+    __m128 r3 = _mm_loadu_ps(a + 3 * lda);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(b, r0);
+    _mm_storeu_ps(b + ldb, r1);
+    _mm_storeu_ps(b + 2 * ldb, r2);
+    _mm_storeu_ps(b + 3 * ldb, r3);
+}
+#endif
+
+#if defined(VECMAT_AVX)
+inline void transpose4(const double * a, size_t lda, double * b, size_t ldb)
+{
+    const __m256d r0 = _mm256_loadu_pd(a);
+    const __m256d r1 = _mm256_loadu_pd(a + lda);
+    const __m256d r2 = _mm256_loadu_pd(a + 2 * lda);
+    const __m256d r3 = _mm256_loadu_pd(a + 3 * lda);
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(b, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(b + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(b + 2 * ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(b + 3 * ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+#endif
+
+}; // end namespace simd
+
+}; // end namespace vecmat
+
+#if defined(VECMAT_DISPATCH_X86)
+#include "vecmat/dispatch.hpp"
+#endif
+
+#endif
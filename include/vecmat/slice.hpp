@@ -0,0 +1,129 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_SLICE_H
+#define VECMAT_SLICE_H
+
+#include <cstdlib>
+
+#include "vecmat/bounds.hpp"
+#include "vecmat/map.hpp"
+#include "vecmat/matrix.hpp"
+
+namespace vecmat {
+
+/** ## Slices
+ *
+ * Columns, rows, and blocks of a matrix as views into its storage.  A
+ * column is contiguous, a row strides across the columns, and a block
+ * keeps the leading dimension of the parent.  The views write through
+ * to the parent and take part in the arithmetic and products of
+ * `vecmat/map.hpp`.  Slicing a `const` matrix yields a read-only view.
+ * Indices outside the parent are checked according to
+ * `VECMAT_BOUNDS_CHECK`, like element access.
+ */
+
+/** ### Columns
+ */
+template <size_t N, size_t M, typename T>
+vector_ref<N, T> col(matrix<N, M, T> & a, const size_t & j)
+{
+    detail::check_bounds(j, M, __func__);
+    return vector_ref<N, T>(a.data + j * N);
+}
+template <size_t N, size_t M, typename T>
+vector_ref<N, const T> col(const matrix<N, M, T> & a, const size_t & j)
+{
+    detail::check_bounds(j, M, __func__);
+    return vector_ref<N, const T>(a.data + j * N);
+}
+template <size_t N, size_t M, typename T>
+vector_ref<N, T> col(const matrix_map<N, M, T> & a, const size_t & j)
+{
+    detail::check_bounds(j, M, __func__);
+    return vector_ref<N, T>(a.ptr + j * a.ld);
+}
+
+/** ### Rows
+ */
+template <size_t N, size_t M, typename T>
+vector_ref<M, T> row(matrix<N, M, T> & a, const size_t & i)
+{
+    detail::check_bounds(i, N, __func__);
+    return vector_ref<M, T>(a.data + i, N);
+}
+template <size_t N, size_t M, typename T>
+vector_ref<M, const T> row(const matrix<N, M, T> & a, const size_t & i)
+{
+    detail::check_bounds(i, N, __func__);
+    return vector_ref<M, const T>(a.data + i, N);
+}
+template <size_t N, size_t M, typename T>
+vector_ref<M, T> row(const matrix_map<N, M, T> & a, const size_t & i)
+{
+    detail::check_bounds(i, N, __func__);
+    return vector_ref<M, T>(a.ptr + i, a.ld);
+}
+
+/** ### Blocks
+ *
+ * `block<R, C>(a, i, j)` is the `R` by `C` block whose upper left
+ * element is `a(i, j)`.
+ */
+template <size_t R, size_t C, size_t N, size_t M, typename T>
+matrix_map<R, C, T> block(matrix<N, M, T> & a,
+                          const size_t & i, const size_t & j)
+{
+    static_assert(R <= N && C <= M, "block is larger than the matrix");
+    detail::check_bounds(i, N - R + 1, __func__);
+    detail::check_bounds(j, M - C + 1, __func__);
+    return matrix_map<R, C, T>(a.data + i + j * N, N);
+}
+template <size_t R, size_t C, size_t N, size_t M, typename T>
+matrix_map<R, C, const T> block(const matrix<N, M, T> & a,
+                                const size_t & i, const size_t & j)
+{
+    static_assert(R <= N && C <= M, "block is larger than the matrix");
+    detail::check_bounds(i, N - R + 1, __func__);
+    detail::check_bounds(j, M - C + 1, __func__);
+    return matrix_map<R, C, const T>(a.data + i + j * N, N);
+}
+template <size_t R, size_t C, size_t N, size_t M, typename T>
+matrix_map<R, C, T> block(const matrix_map<N, M, T> & a,
+                          const size_t & i, const size_t & j)
+{
+    static_assert(R <= N && C <= M, "block is larger than the matrix");
+    detail::check_bounds(i, N - R + 1, __func__);
+    detail::check_bounds(j, M - C + 1, __func__);
+    return matrix_map<R, C, T>(a.ptr + i + j * a.ld, a.ld);
+}
+
+}; // end namespace vecmat
+
+#endif
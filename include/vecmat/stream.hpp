@@ -0,0 +1,248 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_STREAM_H
+#define VECMAT_STREAM_H
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "vecmat/simd.hpp"
+
+/** ## Streaming stores
+ *
+ * Filling, copying, or casting an object far larger than the caches
+ * with ordinary stores first reads every line into the cache and then
+ * evicts whatever the surrounding kernels were working on.  Outputs of
+ * at least `VECMAT_STREAM_THRESHOLD` bytes are instead written with
+ * non-temporal stores, which go straight to memory, while the inputs
+ * are prefetched ahead of the loop.  Every streamed loop ends with a
+ * store fence so the results are visible like ordinary stores.
+ * Processors without non-temporal stores use ordinary ones.
+ */
+#if ! defined(VECMAT_STREAM_THRESHOLD)
+#define VECMAT_STREAM_THRESHOLD (1 << 23)
+#endif
+
+namespace vecmat {
+
+namespace detail {
+
+/** Outputs with fewer bytes than this use ordinary stores */
+static const size_t stream_threshold = VECMAT_STREAM_THRESHOLD;
+
+/** How far ahead, in bytes, the inputs are prefetched */
+static const size_t stream_prefetch = 1024;
+
+/** Marks a constructor that leaves the elements for the caller to write
+ */
+struct uninitialized_t {};
+
+/** Whether an output of `n` elements is streamed
+ */
+template <typename T>
+bool streaming(size_t n)
+{
+    return n >= stream_threshold / sizeof(T);
+}
+
+inline void stream_fence(void)
+{
+#if defined(VECMAT_SSE2)
+    _mm_sfence();
+#endif
+}
+
+template <typename T>
+void prefetch(const T * p)
+{
+#if defined(VECMAT_SSE2)
+    _mm_prefetch(reinterpret_cast<const char *>(p), _MM_HINT_T0);
+#else
+    (void) p;
+#endif
+}
+
+/** ### Sources
+ *
+ * Like the leaves of an expression, a source gives the pack `load<P>(i)`
+ * or the single element `at(i)` of the output starting at `i`, and
+ * prefetches its inputs at `i`.
+ */
+template <typename T>
+struct fill_source {
+    T value;
+
+    template <typename P>
+    typename P::type load(size_t) const
+    {
+        return P::set1(value);
+    }
+    T at(size_t) const
+    {
+        return value;
+    }
+    void prefetch(size_t) const {}
+};
+
+template <typename T, typename U>
+struct cast_source {
+    const U * in;
+
+    template <typename P>
+    typename P::type load(size_t i) const
+    {
+        T t[P::width];
+        for (size_t k = 0; k < P::width; ++k)
+            t[k] = static_cast<T>(in[i + k]);
+        return P::loadu(t);
+    }
+    T at(size_t i) const
+    {
+        return static_cast<T>(in[i]);
+    }
+    void prefetch(size_t i) const
+    {
+        detail::prefetch(in + i);
+    }
+};
+
+template <typename T>
+struct cast_source<T, T> {
+    const T * in;
+
+    template <typename P>
+    typename P::type load(size_t i) const
+    {
+        return P::loadu(in + i);
+    }
+    T at(size_t i) const
+    {
+        return in[i];
+    }
+    void prefetch(size_t i) const
+    {
+        detail::prefetch(in + i);
+    }
+};
+
+/** The same results as `simd::fma`
+ */
+template <typename T>
+struct fma_source {
+    const T * a;
+    const T * b;
+    const T * c;
+
+    template <typename P>
+    typename P::type load(size_t i) const
+    {
+        return P::fmadd(P::loadu(a + i), P::loadu(b + i), P::loadu(c + i));
+    }
+    T at(size_t i) const
+    {
+        return simd::fused(a[i], b[i], c[i]);
+    }
+    void prefetch(size_t i) const
+    {
+        detail::prefetch(a + i);
+        detail::prefetch(b + i);
+        detail::prefetch(c + i);
+    }
+};
+
+/** ### Kernels
+ *
+ * Write `n` elements of `src` to `out` a cache line at a time.  The
+ * elements before the first aligned register and after the last whole
+ * line use ordinary stores.
+ */
+template <typename T, typename S>
+void stream_store(T * out, size_t n, const S & src)
+{
+    typedef simd::pack<T> P;
+    const size_t bytes = P::width * sizeof(T);
+    const size_t line = bytes < 64 ? 64 / sizeof(T) : P::width;
+    const size_t ahead = stream_prefetch / sizeof(T);
+
+    size_t i = 0;
+    for (; i < n && reinterpret_cast<uintptr_t>(out + i) % bytes; ++i)
+        out[i] = src.at(i);
+    for (; i + line <= n; i += line)
+    {
+        if (i + ahead < n)
+            src.prefetch(i + ahead);
+        for (size_t k = 0; k < line; k += P::width)
+            P::stream(out + i + k, src.template load<P>(i + k));
+    }
+    for (; i < n; ++i)
+        out[i] = src.at(i);
+    stream_fence();
+}
+
+template <typename T>
+void stream_fill(T * out, const T & a, size_t n)
+{
+    const fill_source<T> src = {a};
+    stream_store(out, n, src);
+}
+
+template <typename T, typename U>
+void stream_cast(T * out, const U * in, size_t n)
+{
+    const cast_source<T, U> src = {in};
+    stream_store(out, n, src);
+}
+
+/** `d[i] = a[i] b[i] + c[i]` where `d` does not alias the inputs
+ */
+template <typename T>
+void stream_fma(size_t n, const T * a, const T * b, const T * c, T * d)
+{
+    const fma_source<T> src = {a, b, c};
+    stream_store(d, n, src);
+}
+
+/** `d[i] = a[i] b[i] + c[i]` into a new output, streamed when it is
+ * large enough
+ */
+template <typename T>
+void fma_into(size_t n, const T * a, const T * b, const T * c, T * d)
+{
+    if (streaming<T>(n))
+        stream_fma(n, a, b, c, d);
+    else
+        simd::fma(n, a, b, c, d);
+}
+
+}; // end namespace detail
+
+}; // end namespace vecmat
+
+#endif
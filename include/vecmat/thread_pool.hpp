@@ -0,0 +1,315 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_THREAD_POOL_H
+#define VECMAT_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) && defined(_GNU_SOURCE)
+#include <pthread.h>
+#include <sched.h>
+#define VECMAT_PIN_THREADS 1
+#endif
+
+namespace vecmat {
+
+class thread_pool {
+    /** A persistent pool of worker threads
+     *
+     * Spawning threads for every product costs far more than a
+     * moderately sized product, so the workers are created once and
+     * park on a condition variable between jobs.  On Linux each worker
+     * is pinned to one of the processors the process is allowed to run
+     * on so its cache stays warm across jobs.
+     *
+     * The calling thread always takes part in the work, so a pool of
+     * size one has no workers at all and runs everything inline.  The
+     * initial size is taken from the `VECMAT_NUM_THREADS` environment
+     * variable and defaults to one.
+     */
+public:
+    /** The process wide pool
+     */
+    static thread_pool & instance(void)
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    /** The number of threads, including the caller, used for a job
+     *
+     * The parallel kernels ask from any thread, so the count is kept
+     * apart from `workers`, which `resize` rebuilds under `run_mutex`.
+     */
+    size_t size(void) const
+    {
+        return threads.load();
+    }
+
+    /** Change the number of threads
+     *
+     * A size of zero selects one thread per hardware thread.  This
+     * waits for a running job to finish, so calling it from inside a
+     * task would never return and throws std::logic_error instead.
+     */
+    void resize(size_t n)
+    {
+        if (in_task())
+            throw std::logic_error(__func__);
+        std::lock_guard<std::mutex> lock(run_mutex);
+        if (n == 0)
+            n = std::max(1u, std::thread::hardware_concurrency());
+        stop();
+        start(n - 1);
+    }
+
+    /** Run `f(i)` for every `i` in `[0, count)`
+     *
+     * The call blocks until every task is complete.  Tasks are handed
+     * out dynamically so uneven tasks still balance.  If the pool is
+     * already busy, for instance when called from inside a task, the
+     * tasks run serially on the calling thread.  The first exception
+     * thrown by a task is rethrown here.
+     */
+    void run(size_t count, const std::function<void(size_t)> & f)
+    {
+        std::unique_lock<std::mutex> busy(run_mutex, std::try_to_lock);
+        if (!busy.owns_lock() || workers.empty() || count < 2)
+        {
+            task_scope scope;
+            for (size_t i = 0; i < count; ++i)
+                f(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &f;
+            tasks = count;
+            next = 0;
+            active = workers.size();
+            error = nullptr;
+            ++generation;
+        }
+        wake.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return active == 0; });
+        job = nullptr;
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    ~thread_pool(void)
+    {
+        stop();
+    }
+
+private:
+    thread_pool(void) : threads(1), generation(0), quit(false)
+    {
+        size_t n = 1;
+        if (const char * env = std::getenv("VECMAT_NUM_THREADS"))
+            n = std::strtoul(env, nullptr, 10);
+        if (n == 0)
+            n = std::max(1u, std::thread::hardware_concurrency());
+        start(n - 1);
+    }
+    thread_pool(const thread_pool &) = delete;
+    thread_pool & operator=(const thread_pool &) = delete;
+
+    /** New workers start from the current generation so they do not
+     * mistake a job that already finished for a new one.
+     */
+    void start(size_t n)
+    {
+        size_t seen = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = false;
+            seen = generation;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            workers.emplace_back([this, seen] { loop(seen); });
+            pin(workers.back(), i + 1);
+        }
+        threads = workers.size() + 1;
+    }
+
+    void stop(void)
+    {
+        threads = 1;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (auto & t: workers)
+            t.join();
+        workers.clear();
+    }
+
+    static void pin(std::thread & t, size_t k)
+    {
+#if defined(VECMAT_PIN_THREADS)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+            return;
+        size_t count = CPU_COUNT(&allowed);
+        if (count < 2)
+            return;
+        k %= count;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &allowed) && k-- == 0)
+            {
+                cpu_set_t one;
+                CPU_ZERO(&one);
+                CPU_SET(cpu, &one);
+                pthread_setaffinity_np(t.native_handle(), sizeof(one),
+                                       &one);
+                break;
+            }
+#else
+        (void) t;
+        (void) k;
+#endif
+    }
+
+    void loop(size_t seen)
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return quit || generation != seen; });
+                if (quit)
+                    return;
+                seen = generation;
+            }
+            work();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0)
+                done.notify_one();
+        }
+    }
+
+    /** Whether the current thread is running a task
+     */
+    static bool & in_task(void)
+    {
+        static thread_local bool running = false;
+        return running;
+    }
+
+    /** Marks the current thread as running tasks while it lives
+     */
+    struct task_scope {
+        task_scope(void) : outer(in_task())
+        {
+            in_task() = true;
+        }
+        ~task_scope(void)
+        {
+            in_task() = outer;
+        }
+        bool outer;
+    };
+
+    void work(void)
+    {
+        task_scope scope;
+        for (size_t i = next++; i < tasks; i = next++)
+        {
+            try
+            {
+                (*job)(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::atomic<size_t> threads;
+    std::mutex run_mutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(size_t)> * job;
+    size_t tasks;
+    std::atomic<size_t> next;
+    size_t active;
+    size_t generation;
+    bool quit;
+    std::exception_ptr error;
+};
+
+/** ## Convenience access
+ *
+ * Select the number of threads used by the parallel kernels.  Zero
+ * means one per hardware thread and one disables threading.
+ */
+inline void set_num_threads(size_t n)
+{
+    thread_pool::instance().resize(n);
+}
+inline size_t num_threads(void)
+{
+    return thread_pool::instance().size();
+}
+
+/** Run `f(i)` for `i` in `[0, count)` across the pool
+ */
+template <typename F>
+void parallel_for(size_t count, F f)
+{
+    thread_pool::instance().run(count, std::function<void(size_t)>(f));
+}
+
+}; // end namespace vecmat
+
+#endif
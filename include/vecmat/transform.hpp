@@ -0,0 +1,242 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_TRANSFORM_H
+#define VECMAT_TRANSFORM_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <type_traits>
+
+#include "vecmat/batch.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/thread_pool.hpp"
+#include "vecmat/vector.hpp"
+
+namespace vecmat {
+
+namespace detail {
+
+/** Inputs with at least this many points are split across threads */
+static const size_t transform_parallel_threshold = 16384;
+
+/** The number of points handed to a thread at a time */
+static const size_t transform_chunk = 4096;
+
+/** Run `f(begin, end)` over `[0, count)` in chunks, in parallel when
+ * the input is large enough and the pool has more than one thread.
+ * The chunk boundaries are multiples of `align`.  `f` is never called
+ * with an empty range, so it may index the first element.
+ */
+template <typename F>
+void transform_chunks(size_t count, size_t align, F f)
+{
+    if (count == 0)
+        return;
+    if (count < transform_parallel_threshold || num_threads() < 2)
+    {
+        f(0, count);
+        return;
+    }
+    const size_t chunk = (transform_chunk + align - 1) / align * align;
+    parallel_for((count + chunk - 1) / chunk, [=](size_t t) {
+        f(t * chunk, std::min(count, (t + 1) * chunk));
+    });
+}
+
+/** Transform `count` points with an implicit `w` of one
+ */
+template <typename T>
+void transform_points(const T * m, const vector<3, T> * in,
+                      vector<3, T> * out, size_t count, bool divide)
+{
+    typedef simd::quad<T> P;
+    const typename P::type a0 = P::loadu(m);
+    const typename P::type a1 = P::loadu(m + 4);
+    const typename P::type a2 = P::loadu(m + 8);
+    const typename P::type a3 = P::loadu(m + 12);
+    T r[4];
+    for (size_t i = 0; i < count; ++i)
+    {
+        const T * p = in[i].data;
+        typename P::type s = P::fmadd(a0, P::set1(p[0]), a3);
+        s = P::fmadd(a1, P::set1(p[1]), s);
+        s = P::fmadd(a2, P::set1(p[2]), s);
+        P::storeu(r, s);
+        T * q = out[i].data;
+        if (divide)
+        {
+            q[0] = r[0] / r[3];
+            q[1] = r[1] / r[3];
+            q[2] = r[2] / r[3];
+        }
+        else
+        {
+            q[0] = r[0];
+            q[1] = r[1];
+            q[2] = r[2];
+        }
+    }
+}
+
+/** Transform `count` points held in the `N` lanes at `in` into the
+ * `N` lanes at `out`.  Every entry of the matrix stays in a register
+ * for the whole loop.  With three lanes `w` is implicitly one and the
+ * `w` of the result is only used for the divide.
+ */
+template <size_t N, typename T>
+void transform_lanes(const T * m, const T * const * in, T * const * out,
+                     size_t count, bool divide)
+{
+#if defined(VECMAT_DISPATCH_X86)
+    if (simd::dispatch::transform_lanes<N>(m, in, out, count, divide))
+        return;
+#endif
+    typedef simd::pack<T> P;
+    typename P::type a[4][4];
+    for (size_t j = 0; j < 4; ++j)
+        for (size_t i = 0; i < 4; ++i)
+            a[i][j] = P::set1(m[i + 4 * j]);
+
+    for (size_t k = 0; k < count; k += P::width)
+    {
+        typename P::type p[N];
+        for (size_t j = 0; j < N; ++j)
+            p[j] = P::loadu(in[j] + k);
+        typename P::type r[4];
+        for (size_t i = 0; i < 4; ++i)
+        {
+            r[i] = N == 4 ? P::mul(a[i][0], p[0])
+                          : P::fmadd(a[i][0], p[0], a[i][3]);
+            r[i] = P::fmadd(a[i][1], p[1], r[i]);
+            r[i] = P::fmadd(a[i][2], p[2], r[i]);
+            if (N == 4)
+                r[i] = P::fmadd(a[i][3], p[N - 1], r[i]);
+        }
+        if (divide)
+        {
+            for (size_t i = 0; i < 3; ++i)
+                r[i] = P::div(r[i], r[3]);
+            r[3] = P::div(r[3], r[3]);
+        }
+        for (size_t i = 0; i < N; ++i)
+            P::storeu(out[i] + k, r[i]);
+    }
+}
+
+}; // end namespace detail
+
+/** ## Batched transforms
+ *
+ * Apply one 4x4 transform to many points.  The matrix is loaded into
+ * registers once and large inputs are spread across the thread pool.
+ * Three component points have an implicit `w` of one.  With
+ * `perspective_divide` the result is divided by its `w`, which for
+ * four component points leaves `w` as one.  The output may be the
+ * same array as the input but must not otherwise overlap it.
+ */
+template <typename T>
+void transform(const matrix<4, 4, T> & m, const vector<4, T> * in,
+               vector<4, T> * out, size_t count,
+               bool perspective_divide = false)
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "transforms need floating point values");
+    detail::transform_chunks(count, 1, [&](size_t i0, size_t i1) {
+        simd::mat4_columns(m.data, in[i0].data, out[i0].data, i1 - i0);
+        if (perspective_divide)
+            for (size_t i = i0; i < i1; ++i)
+            {
+                T * q = out[i].data;
+                const T w = q[3];
+                q[0] /= w;
+                q[1] /= w;
+                q[2] /= w;
+                q[3] /= w;
+            }
+    });
+}
+
+template <typename T>
+void transform(const matrix<4, 4, T> & m, const vector<3, T> * in,
+               vector<3, T> * out, size_t count,
+               bool perspective_divide = false)
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "transforms need floating point values");
+    detail::transform_chunks(count, 1, [&](size_t i0, size_t i1) {
+        detail::transform_points(m.data, in + i0, out + i0, i1 - i0,
+                                 perspective_divide);
+    });
+}
+
+/** The structure of arrays form works a full pack of points at a time.
+ * Writing into an existing batch avoids allocating (and faulting in)
+ * the output on every call; `out` is resized to match `in` if needed
+ * and may be `in` itself.
+ */
+template <size_t N, typename T>
+void transform(const matrix<4, 4, T> & m, const vector_batch<N, T> & in,
+               vector_batch<N, T> & out, bool perspective_divide = false)
+{
+    static_assert(N == 3 || N == 4, "transforms need 3 or 4 components");
+    static_assert(std::is_floating_point<T>::value,
+                  "transforms need floating point values");
+
+    if (out.size() != in.size())
+        out = vector_batch<N, T>(in.size());
+    const size_t align = 64 / sizeof(T);
+    detail::transform_chunks(in.lane_stride(), align,
+                             [&](size_t i0, size_t i1) {
+        const T * x[N];
+        T * y[N];
+        for (size_t k = 0; k < N; ++k)
+        {
+            x[k] = in.lane(k) + i0;
+            y[k] = out.lane(k) + i0;
+        }
+        detail::transform_lanes<N>(m.data, x, y, i1 - i0,
+                                   perspective_divide);
+    });
+}
+
+template <size_t N, typename T>
+vector_batch<N, T> transform(const matrix<4, 4, T> & m,
+                             const vector_batch<N, T> & in,
+                             bool perspective_divide = false)
+{
+    vector_batch<N, T> out(in.size());
+    transform(m, in, out, perspective_divide);
+    return out;
+}
+
+}; // end namespace vecmat
+
+#endif
@@ -0,0 +1,286 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_TRANSPOSE_H
+#define VECMAT_TRANSPOSE_H
+
+#include <cstdlib>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+#include "vecmat/map.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/simd.hpp"
+
+namespace vecmat {
+
+template <size_t N, size_t M, typename T>
+struct matrix_transpose {
+    /** The transpose of a matrix without moving any data
+     *
+     * This is the `N` by `M` transpose of the `M` by `N` column-major
+     * storage at `ptr` with leading dimension `ld`.  Element `(i, j)`
+     * is element `(j, i)` of the storage, so the rows of the view are
+     * contiguous.  Like the other views it writes through and `dot`
+     * reads it in place; converting it to a `matrix` is the only way a
+     * transposed copy is made.
+     */
+    typedef typename std::remove_const<T>::type type_t;
+
+    T * ptr;        //! The first element of the storage
+    size_t ld;      //! The distance between columns of the storage
+
+    explicit matrix_transpose(T * p, size_t lead = M) : ptr(p), ld(lead) {}
+    matrix_transpose(const matrix_transpose &) = default;
+    template <typename U>
+    matrix_transpose(const matrix_transpose<N, M, U> & a)
+        : ptr(a.ptr), ld(a.ld) {}
+
+    /** ## Access operations
+     */
+    T & operator[](const size_t & k) const
+    {
+        return ptr[k / N + (k % N) * ld];
+    }
+    T & operator()(const size_t & i, const size_t & j) const
+    {
+        return ptr[j + i * ld];
+    }
+
+    /** Copy the elements into a new matrix
+     */
+    operator matrix<N, M, type_t>() const
+    {
+        matrix<N, M, type_t> a;
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < M; ++j)
+                a.data[i + j * N] = ptr[j + i * ld];
+        return a;
+    }
+
+    /** ## Assignment
+     *
+     * Element by element through the transposed layout.
+     */
+    matrix_transpose & operator=(const matrix_transpose & a)
+    {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < M; ++j)
+                (*this)(i, j) = a(i, j);
+        return *this;
+    }
+    template <typename V>
+    matrix_transpose & operator=(const V & a)
+    {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < M; ++j)
+                (*this)(i, j) = a(i, j);
+        return *this;
+    }
+};
+
+template <size_t N, size_t M, typename T>
+struct matrix_traits<matrix_transpose<N, M, T> > {
+    static const bool value = true;
+    static const bool view = true;
+    static const bool trans = true;
+    static const size_t rows = N;
+    static const size_t cols = M;
+    typedef typename std::remove_const<T>::type type_t;
+    static const type_t * pointer(const matrix_transpose<N, M, T> & a)
+    {
+        return a.ptr;
+    }
+    static size_t ld(const matrix_transpose<N, M, T> & a) { return a.ld; }
+};
+
+/** ## Transpose
+ *
+ * `transpose(a)` returns a view of the transpose of `a`.  Transposing
+ * a transpose gives back a plain view of the original storage.
+ */
+template <size_t N, size_t M, typename T>
+matrix_transpose<M, N, T> transpose(matrix<N, M, T> & a)
+{
+    return matrix_transpose<M, N, T>(a.data, N);
+}
+template <size_t N, size_t M, typename T>
+matrix_transpose<M, N, const T> transpose(const matrix<N, M, T> & a)
+{
+    return matrix_transpose<M, N, const T>(a.data, N);
+}
+template <size_t N, size_t M, typename T>
+matrix_transpose<M, N, T> transpose(const matrix_map<N, M, T> & a)
+{
+    return matrix_transpose<M, N, T>(a.ptr, a.ld);
+}
+template <size_t N, size_t M, typename T>
+matrix_map<M, N, T> transpose(const matrix_transpose<N, M, T> & a)
+{
+    return matrix_map<M, N, T>(a.ptr, a.ld);
+}
+
+namespace detail {
+
+/** Blocks at most this many rows and columns are done directly */
+static const size_t transpose_leaf = 16;
+
+/** Write the transpose of the `m` by `n` block `a` into `b`
+ *
+ * Halve the longer side until the blocks are small enough that the
+ * rows of the source and the destination both stay in cache.  This
+ * adapts to every level of the cache (and the TLB) without knowing
+ * their sizes.  The leaves go 4x4 at a time through the SIMD kernel.
+ */
+template <typename T>
+void transpose_recursive(size_t m, size_t n, const T * a, size_t lda,
+                         T * b, size_t ldb)
+{
+    if (m <= transpose_leaf && n <= transpose_leaf)
+    {
+        size_t j = 0;
+        for (; j + 4 <= n; j += 4)
+        {
+            size_t i = 0;
+            for (; i + 4 <= m; i += 4)
+                simd::transpose4(a + i + j * lda, lda, b + j + i * ldb, ldb);
+            for (; i < m; ++i)
+                for (size_t jj = j; jj < j + 4; ++jj)
+                    b[jj + i * ldb] = a[i + jj * lda];
+        }
+        for (; j < n; ++j)
+            for (size_t i = 0; i < m; ++i)
+                b[j + i * ldb] = a[i + j * lda];
+    }
+    else if (m >= n)
+    {
+        const size_t h = (m / 2 + 3) / 4 * 4;
+        transpose_recursive(h, n, a, lda, b, ldb);
+        transpose_recursive(m - h, n, a + h, lda, b + h * ldb, ldb);
+    }
+    else
+    {
+        const size_t h = (n / 2 + 3) / 4 * 4;
+        transpose_recursive(m, h, a, lda, b, ldb);
+        transpose_recursive(m, n - h, a + h * lda, lda, b + h, ldb);
+    }
+}
+
+/** Exchange the `m` by `n` block `a` with the transpose of the `n` by
+ * `m` block `b`, splitting the same way.
+ */
+template <typename T>
+void transpose_swap(size_t m, size_t n, T * a, T * b, size_t ld)
+{
+    if (m <= transpose_leaf && n <= transpose_leaf)
+    {
+        for (size_t j = 0; j < n; ++j)
+            for (size_t i = 0; i < m; ++i)
+                std::swap(a[i + j * ld], b[j + i * ld]);
+    }
+    else if (m >= n)
+    {
+        const size_t h = m / 2;
+        transpose_swap(h, n, a, b, ld);
+        transpose_swap(m - h, n, a + h, b + h * ld, ld);
+    }
+    else
+    {
+        const size_t h = n / 2;
+        transpose_swap(m, h, a, b, ld);
+        transpose_swap(m, n - h, a + h * ld, b + h, ld);
+    }
+}
+
+/** Transpose the `n` by `n` block `a` in place: transpose the diagonal
+ * blocks and exchange the off-diagonal ones.
+ */
+template <typename T>
+void transpose_square(size_t n, T * a, size_t ld)
+{
+    if (n <= transpose_leaf)
+    {
+        for (size_t j = 1; j < n; ++j)
+            for (size_t i = 0; i < j; ++i)
+                std::swap(a[i + j * ld], a[j + i * ld]);
+        return;
+    }
+    const size_t h = n / 2;
+    transpose_square(h, a, ld);
+    transpose_square(n - h, a + h + h * ld, ld);
+    transpose_swap(h, n - h, a + h * ld, a + h, ld);
+}
+
+}; // end namespace detail
+
+/** ## Materialized transpose
+ *
+ * When the transpose really has to exist, for example to hand a
+ * row-major array to a C API, `transpose_copy` forms it with a cache
+ * oblivious recursion instead of a strided element loop.  The raw form
+ * writes the transpose of the `m` by `n` column-major array `a` into
+ * the `n` by `m` array `b`; the two must not overlap.
+ */
+template <typename T>
+void transpose_copy(size_t m, size_t n, const T * a, size_t lda,
+                    T * b, size_t ldb)
+{
+    detail::transpose_recursive(m, n, a, lda, b, ldb);
+}
+
+template <size_t N, size_t M, typename T>
+matrix<M, N, T> transpose_copy(const matrix<N, M, T> & a)
+{
+    matrix<M, N, T> b;
+    detail::transpose_recursive(N, M, a.data, N, b.data, M);
+    return b;
+}
+
+/** Transpose a square matrix in place
+ */
+template <size_t N, typename T>
+matrix<N, N, T> & transpose_inplace(matrix<N, N, T> & a)
+{
+    detail::transpose_square(N, a.data, N);
+    return a;
+}
+
+/** ## Stream operators
+ */
+template <size_t N, size_t M, typename T>
+std::ostream & operator<<(std::ostream & os,
+                          const matrix_transpose<N, M, T> & a)
+{
+    return os << matrix<N, M, typename matrix_transpose<N, M, T>::type_t>(a);
+}
+
+}; // end namespace vecmat
+
+#endif
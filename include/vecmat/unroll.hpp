@@ -0,0 +1,305 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VECMAT_UNROLL_H
+#define VECMAT_UNROLL_H
+
+#include <cstdlib>
+#include <type_traits>
+
+#include "vecmat/simd.hpp"
+
+namespace vecmat {
+
+namespace detail {
+
+/** ## Compile time unrolling
+ *
+ * The small types (`vec2` through `vec4`, `mat2` through `mat4`) are
+ * far too short for a loop to pay for itself, and whether the compiler
+ * unrolls a loop depends on the optimization level.  For sizes up to
+ * `unroll_limit` in each dimension we instead expand the operations
+ * over a pack of compile time indices, so the generated code is
+ * straight line at any optimization level.  Larger sizes run the
+ * SIMD kernels, or plain loops during constant evaluation.
+ */
+static const size_t unroll_limit = 8;
+
+/** The indices `0` through `N - 1` as a type (`std::index_sequence` is
+ * not available until C++14)
+ */
+template <size_t... I>
+struct index_sequence {};
+
+template <size_t N, size_t... I>
+struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> {};
+template <size_t... I>
+struct make_index_sequence<0, I...> : index_sequence<I...> {};
+
+/** Tag for sizes that are not unrolled */
+template <size_t N>
+struct loop {};
+
+/** The indices of an `N` by `M` array when it is small enough to
+ * unroll and a `loop` otherwise
+ */
+template <size_t N, size_t M = 1,
+          bool = (N <= unroll_limit && M <= unroll_limit)>
+struct unrolled {
+    typedef make_index_sequence<N * M> type;
+};
+template <size_t N, size_t M>
+struct unrolled<N, M, false> {
+    typedef loop<N * M> type;
+};
+
+template <size_t N, size_t M = 1>
+using unrolled_t = typename unrolled<N, M>::type;
+
+/** The output indices of an `N` by `M` times `M` by `O` product */
+template <size_t N, size_t M, size_t O>
+using product_indices =
+    typename unrolled<N, O, (N <= unroll_limit && M <= unroll_limit &&
+                             O <= unroll_limit)>::type;
+
+/** Element `I` of an `N` element array, or zero past the end
+ *
+ * This lets resizing code read "past the end" without ever forming the
+ * out of bounds access.
+ */
+template <size_t I, size_t N, typename T>
+VECMAT_CONSTEXPR typename std::enable_if<(I < N), T>::type element(const T * a)
+{
+    return a[I];
+}
+template <size_t I, size_t N, typename T>
+VECMAT_CONSTEXPR typename std::enable_if<(I >= N), T>::type element(const T *)
+{
+    return static_cast<T>(0);
+}
+
+/** ## Element-wise operations
+ *
+ * Each has an unrolled form and a loop form.  The unrolled forms
+ * expand into an array initializer because that is the one place C++11
+ * guarantees the expansions are evaluated in order.
+ */
+template <template <typename> class Op, typename T, size_t... I>
+VECMAT_CONSTEXPR void transform(T * a, const T * b, index_sequence<I...>)
+{
+    typedef simd::scalar<T> S;
+    const int expand[] = {0, (a[I] = Op<S>::apply(a[I], b[I]), 0)...};
+    (void)expand;
+}
+template <template <typename> class Op, typename T, size_t N>
+VECMAT_CONSTEXPR void transform(T * a, const T * b, loop<N>)
+{
+    if (VECMAT_CONSTANT_EVALUATED())
+        for (size_t i = 0; i < N; ++i)
+            a[i] = Op<simd::scalar<T> >::apply(a[i], b[i]);
+    else
+        simd::transform<Op>(a, b, N);
+}
+
+template <template <typename> class Op, typename T, size_t... I>
+VECMAT_CONSTEXPR void broadcast(T * a, const T & b, index_sequence<I...>)
+{
+    typedef simd::scalar<T> S;
+    const int expand[] = {0, (a[I] = Op<S>::apply(a[I], b), 0)...};
+    (void)expand;
+}
+template <template <typename> class Op, typename T, size_t N>
+VECMAT_CONSTEXPR void broadcast(T * a, const T & b, loop<N>)
+{
+    if (VECMAT_CONSTANT_EVALUATED())
+        for (size_t i = 0; i < N; ++i)
+            a[i] = Op<simd::scalar<T> >::apply(a[i], b);
+    else
+        simd::broadcast<Op>(a, b, N);
+}
+
+template <typename T, size_t... I>
+VECMAT_CONSTEXPR void negate(T * a, const T * b, index_sequence<I...>)
+{
+    const int expand[] = {0, (a[I] = -b[I], 0)...};
+    (void)expand;
+}
+template <typename T, size_t N>
+VECMAT_CONSTEXPR void negate(T * a, const T * b, loop<N>)
+{
+    if (VECMAT_CONSTANT_EVALUATED())
+        for (size_t i = 0; i < N; ++i)
+            a[i] = -b[i];
+    else
+        simd::negate(a, b, N);
+}
+
+template <typename T, size_t... I>
+VECMAT_CONSTEXPR void fill(T * a, const T & b, index_sequence<I...>)
+{
+    const int expand[] = {0, (a[I] = b, 0)...};
+    (void)expand;
+}
+template <typename T, size_t N>
+VECMAT_CONSTEXPR void fill(T * a, const T & b, loop<N>)
+{
+    if (VECMAT_CONSTANT_EVALUATED())
+        for (size_t i = 0; i < N; ++i)
+            a[i] = b;
+    else
+        simd::fill(a, b, N);
+}
+
+/** ## Reductions
+ *
+ * The inner product of `a` and `b` where consecutive elements of `a`
+ * are `S` apart.  The unrolled sum runs in index order, exactly like
+ * the loop.  At run time the contiguous loop form goes to the SIMD
+ * kernel and its independent accumulators instead.
+ */
+template <size_t S, typename T, size_t... I>
+VECMAT_CONSTEXPR T inner(const T * a, const T * b, index_sequence<I...>)
+{
+    T ret = 0;
+    const int expand[] = {0, (ret += a[I * S] * b[I], 0)...};
+    (void)expand;
+    return ret;
+}
+template <size_t S, typename T, size_t N>
+VECMAT_CONSTEXPR T inner(const T * a, const T * b, loop<N>)
+{
+    if (S == 1 && ! VECMAT_CONSTANT_EVALUATED())
+        return simd::inner(a, b, N);
+    T ret = 0;
+    for (size_t i = 0; i < N; ++i)
+        ret += a[i * S] * b[i];
+    return ret;
+}
+
+/** ## Small products
+ *
+ * `c = a b` where `a` is `N` by `M` and `b` is `M` by `O`, computing
+ * each of the `N O` outputs (indexed by `K`) as an unrolled inner
+ * product of a row of `a` and a column of `b`.  The loop forms are
+ * only for constant evaluation; at run time the large products go to
+ * the GEMM and GEMV kernels.
+ */
+template <size_t N, size_t M, typename T, size_t... K>
+VECMAT_CONSTEXPR void
+product(const T * a, const T * b, T * c, index_sequence<K...>)
+{
+    const int expand[] = {0, (c[K] = inner<N>(a + K % N, b + K / N * M,
+                                               make_index_sequence<M>()),
+                              0)...};
+    (void)expand;
+}
+template <size_t N, size_t M, typename T, size_t L>
+VECMAT_CONSTEXPR void product(const T * a, const T * b, T * c, loop<L>)
+{
+    for (size_t k = 0; k < L; ++k)
+        c[k] = inner<N>(a + k % N, b + k / N * M, loop<M>());
+}
+
+/** `c = a' b` where `a` is `N` by `M` and `b` has `N` entries
+ */
+template <size_t N, typename T, size_t... K>
+VECMAT_CONSTEXPR void
+product_t(const T * a, const T * b, T * c, index_sequence<K...>)
+{
+    const int expand[] = {0, (c[K] = inner<1>(a + K * N, b,
+                                              make_index_sequence<N>()),
+                              0)...};
+    (void)expand;
+}
+template <size_t N, typename T, size_t L>
+VECMAT_CONSTEXPR void product_t(const T * a, const T * b, T * c, loop<L>)
+{
+    for (size_t k = 0; k < L; ++k)
+        c[k] = inner<1>(a + k * N, b, loop<N>());
+}
+
+/** ## Construction
+ *
+ * Write `b` down the diagonal of an `N` by `N` array.
+ */
+template <size_t N, typename T, size_t... I>
+VECMAT_CONSTEXPR void diagonal(T * a, const T & b, index_sequence<I...>)
+{
+    const int expand[] = {0, (a[I * (N + 1)] = b, 0)...};
+    (void)expand;
+}
+template <size_t N, typename T, size_t L>
+VECMAT_CONSTEXPR void diagonal(T * a, const T & b, loop<L>)
+{
+    for (size_t i = 0; i < N; ++i)
+        a[i * (N + 1)] = b;
+}
+
+/** Element `(I, J)` of an `N` by `M` array, or zero outside of it
+ */
+template <size_t I, size_t J, size_t N, size_t M, typename T>
+VECMAT_CONSTEXPR typename std::enable_if<(I < N && J < M), T>::type
+element(const T * a)
+{
+    return a[I + J * N];
+}
+template <size_t I, size_t J, size_t N, size_t M, typename T>
+VECMAT_CONSTEXPR typename std::enable_if<!(I < N && J < M), T>::type
+element(const T *)
+{
+    return static_cast<T>(0);
+}
+
+/** Copy and cast the `I` by `J` array `a` into the `N` by `M` array
+ * `b`, dropping the excess and filling the rest with zero.
+ */
+template <size_t N, size_t I, size_t J, typename T, typename U,
+          size_t... K>
+VECMAT_CONSTEXPR void resize(T * b, const U * a, index_sequence<K...>)
+{
+    const int expand[] = {
+        0, (b[K] = static_cast<T>(element<K % N, K / N, I, J>(a)), 0)...};
+    (void)expand;
+}
+template <size_t N, size_t I, size_t J, typename T, typename U, size_t L>
+VECMAT_CONSTEXPR void resize(T * b, const U * a, loop<L>)
+{
+    for (size_t k = 0; k < L; ++k)
+    {
+        const size_t n = k % N;
+        const size_t m = k / N;
+        b[k] = static_cast<T>(n < I && m < J ? a[n + m * I] : 0);
+    }
+}
+
+}; // end namespace detail
+
+}; // end namespace vecmat
+
+#endif
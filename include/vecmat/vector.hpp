@@ -35,9 +35,29 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <limits>
 #include <stdexcept>
 #include <iostream>
+#include <type_traits>
+
+#include "vecmat/aligned.hpp"
+#include "vecmat/bounds.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/unroll.hpp"
 
 namespace vecmat {
 
+/** ## Scalars
+ *
+ * The binary operators broadcast scalars across every element.  Any
+ * arithmetic type is a scalar.  Other numeric types may opt in by
+ * specializing this trait.
+ */
+template <typename U>
+struct is_scalar : std::is_arithmetic<U> {};
+
+/** Lazily evaluated expressions (see `vecmat/expression.hpp`)
+ */
+template <typename E>
+struct expression;
+
 template <size_t N, typename T>
 struct vector {
     /** A generic vector for mathematical operations
@@ -63,7 +83,8 @@ struct vector {
 
     /** ## Member data
      */
-    T data[N];          //! The internal storage for the array
+    //! The internal storage for the array
+    alignas(detail::storage_alignment<T, N>::value) T data[N];
 
     /** ## Type definitions
      */
@@ -78,19 +99,19 @@ struct vector {
      * because we primarily care about forward traversal for
      * mathematical vectors.
      */
-    iterator begin(void)
+    VECMAT_CONSTEXPR iterator begin(void)
     {
         return data;
     }
-    iterator end(void)
+    VECMAT_CONSTEXPR iterator end(void)
     {
         return data + N;
     }
-    const_iterator cbegin(void) const
+    VECMAT_CONSTEXPR const_iterator cbegin(void) const
     {
         return const_cast<const_iterator>(data);
     }
-    const_iterator cend(void) const
+    VECMAT_CONSTEXPR const_iterator cend(void) const
     {
         return const_cast<const_iterator>(data + N);
     }
@@ -98,27 +119,25 @@ struct vector {
     /** ## Access operations
      *
      * We provide the usual `[i]` zero based access operator, but we
-     * also provide `(i)` for symmetry with the matrix class.  These
-     * will throw std::out_of_range if the index is larger than the
-     * vector.
+     * also provide `(i)` for symmetry with the matrix class.  The
+     * index is checked according to `VECMAT_BOUNDS_CHECK` (see
+     * `vecmat/bounds.hpp`).
      */
-    const T & operator[](const size_t & i) const
+    VECMAT_CONSTEXPR const T & operator[](const size_t & i) const
     {
-        if (i >= N)
-            std::out_of_range(__func__);
+        detail::check_bounds(i, N, __func__);
         return data[i];
     }
-    T & operator[](const size_t & i)
+    VECMAT_CONSTEXPR T & operator[](const size_t & i)
     {
-        if (i >= N)
-            std::out_of_range(__func__);
+        detail::check_bounds(i, N, __func__);
         return data[i];
     }
-    const T & operator()(const size_t & i) const
+    VECMAT_CONSTEXPR const T & operator()(const size_t & i) const
     {
         return operator[](i);
     }
-    T & operator()(const size_t & i)
+    VECMAT_CONSTEXPR T & operator()(const size_t & i)
     {
         return operator[](i);
     }
@@ -127,12 +146,10 @@ struct vector {
      *
      * Negating a vector negates each element of the vector.
      */
-    vector operator-()
+    VECMAT_CONSTEXPR vector operator-() const
     {
-        vector<N, T> b;
-        for (size_t i = 0; i < N; ++i)
-            b[i] = -operator[](i);
-
+        vector<N, T> b {};
+        detail::negate(b.data, data, detail::unrolled_t<N>());
         return b;
     }
 
@@ -141,10 +158,9 @@ struct vector {
      * Scalar assignment broadcasts the scalar to every element of the
      * vector.
      */
-    vector operator=(T a)
+    VECMAT_CONSTEXPR vector operator=(T a)
     {
-        for (auto & x: *this)
-            x = a;
+        detail::fill(data, a, detail::unrolled_t<N>());
         return *this;
     }
 
@@ -158,58 +174,87 @@ struct vector {
      */
     /** ### Scalar compound assignment
      */
-    vector & operator+=(const T & a)
+    VECMAT_CONSTEXPR vector & operator+=(const T & a)
     {
-        for (auto & v: *this)
-            v += a;
+        detail::broadcast<simd::plus>(data, a, detail::unrolled_t<N>());
         return *this;
     }
-    vector & operator-=(const T & a)
+    VECMAT_CONSTEXPR vector & operator-=(const T & a)
     {
-        for (auto & v: *this)
-            v -= a;
+        detail::broadcast<simd::minus>(data, a, detail::unrolled_t<N>());
         return *this;
     }
-    vector & operator*=(const T & a)
+    VECMAT_CONSTEXPR vector & operator*=(const T & a)
     {
-        for (auto & v: *this)
-            v *= a;
+        detail::broadcast<simd::multiplies>(data, a, detail::unrolled_t<N>());
         return *this;
     }
-    vector & operator/=(const T & a)
+    VECMAT_CONSTEXPR vector & operator/=(const T & a)
     {
-        for (auto & v: *this)
-            v /= a;
+        detail::broadcast<simd::divides>(data, a, detail::unrolled_t<N>());
         return *this;
     }
 
     /** ### Vector compound assignments
      */
-    vector & operator+=(const vector & a)
+    VECMAT_CONSTEXPR vector & operator+=(const vector & a)
     {
-        std::transform(a.cbegin(), a.cend(), begin(), begin(),
-                       [](T s, T t) -> T { return t + s; });
+        detail::transform<simd::plus>(data, a.data, detail::unrolled_t<N>());
         return *this;
     }
-    vector & operator-=(const vector & a)
+    VECMAT_CONSTEXPR vector & operator-=(const vector & a)
     {
-        std::transform(a.cbegin(), a.cend(), begin(), begin(),
-                       [](T s, T t) -> T { return t - s; });
+        detail::transform<simd::minus>(data, a.data, detail::unrolled_t<N>());
         return *this;
     }
-    vector & operator*=(const vector & a)
+    VECMAT_CONSTEXPR vector & operator*=(const vector & a)
     {
-        std::transform(a.cbegin(), a.cend(), begin(), begin(),
-                       [](T s, T t) -> T { return t * s; });
+        detail::transform<simd::multiplies>(data, a.data,
+                                            detail::unrolled_t<N>());
         return *this;
     }
-    vector & operator/=(const vector & a)
+    VECMAT_CONSTEXPR vector & operator/=(const vector & a)
     {
-        std::transform(a.cbegin(), a.cend(), begin(), begin(),
-                       [](T s, T t) -> T { return t / s; });
+        detail::transform<simd::divides>(data, a.data,
+                                         detail::unrolled_t<N>());
         return *this;
     }
 
+    /** ### Expression assignment
+     *
+     * Assigning a lazy expression evaluates it in a single pass.  These
+     * are only usable after including `vecmat/expression.hpp`, and the
+     * expression must have exactly this shape and element type.
+     */
+    template <typename E>
+    vector & operator=(const expression<E> & e)
+    {
+        static_assert(std::is_same<typename E::result_t, vector>::value,
+                      "the expression must have the shape of the vector");
+        e.self().evaluate(data);
+        return *this;
+    }
+    template <typename E>
+    vector & operator+=(const expression<E> & e)
+    {
+        return *this = lazy(*this) + e;
+    }
+    template <typename E>
+    vector & operator-=(const expression<E> & e)
+    {
+        return *this = lazy(*this) - e;
+    }
+    template <typename E>
+    vector & operator*=(const expression<E> & e)
+    {
+        return *this = lazy(*this) * e;
+    }
+    template <typename E>
+    vector & operator/=(const expression<E> & e)
+    {
+        return *this = lazy(*this) / e;
+    }
+
     /** ## Stream operations
      *
      * We output as a comma separated list of values.  On the reverse,
@@ -230,22 +275,28 @@ struct vector {
  * operations, we need to handle the scalar on the left or the scalar on
  * the right.  The only exception is division where dividing a scalar by
  * a vector does not make sense.  In all cases, we operate elementwise
- * and broadcast the scalars.
+ * and broadcast the scalars.  Only types satisfying `is_scalar` are
+ * broadcast so other vector-like types can provide their own
+ * overloads.
  */
 /** ### Addition
  */
 template <size_t N, typename T, typename U>
-vector<N, T> operator+(const U & a, vector<N, T> b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, vector<N, T>>::type
+operator+(const U & a, vector<N, T> b)
 {
     return b += static_cast<T>(a);
 }
 template <size_t N, typename T, typename U>
-vector<N, T> operator+(vector<N, T> a, const U & b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, vector<N, T>>::type
+operator+(vector<N, T> a, const U & b)
 {
     return a += static_cast<T>(b);
 }
 template <size_t N, typename T>
-vector<N, T> operator+(vector<N, T> a, const vector<N, T> & b)
+VECMAT_CONSTEXPR vector<N, T> operator+(vector<N, T> a, const vector<N, T> & b)
 {
     return a += b;
 }
@@ -253,17 +304,21 @@ vector<N, T> operator+(vector<N, T> a, const vector<N, T> & b)
 /** ### Subtraction
  */
 template <size_t N, typename T, typename U>
-vector<N, T> operator-(const U & a, vector<N, T> b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, vector<N, T>>::type
+operator-(const U & a, vector<N, T> b)
 {
     return (-b) += static_cast<T>(a);
 }
 template <size_t N, typename T, typename U>
-vector<N, T> operator-(vector<N, T> a, const U & b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, vector<N, T>>::type
+operator-(vector<N, T> a, const U & b)
 {
     return a -= static_cast<T>(b);
 }
 template <size_t N, typename T>
-vector<N, T> operator-(vector<N, T> a, const vector<N, T> & b)
+VECMAT_CONSTEXPR vector<N, T> operator-(vector<N, T> a, const vector<N, T> & b)
 {
     return a -= b;
 }
@@ -271,17 +326,21 @@ vector<N, T> operator-(vector<N, T> a, const vector<N, T> & b)
 /** ### Multiplication
  */
 template <size_t N, typename T, typename U>
-vector<N, T> operator*(const U & a, vector<N, T> b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, vector<N, T>>::type
+operator*(const U & a, vector<N, T> b)
 {
     return b *= static_cast<T>(a);
 }
 template <size_t N, typename T, typename U>
-vector<N, T> operator*(vector<N, T> a, const U & b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, vector<N, T>>::type
+operator*(vector<N, T> a, const U & b)
 {
     return a *= static_cast<T>(b);
 }
 template <size_t N, typename T>
-vector<N, T> operator*(vector<N, T> a, const vector<N, T> & b)
+VECMAT_CONSTEXPR vector<N, T> operator*(vector<N, T> a, const vector<N, T> & b)
 {
     return a *= b;
 }
@@ -289,12 +348,14 @@ vector<N, T> operator*(vector<N, T> a, const vector<N, T> & b)
 /** ### Division
  */
 template <size_t N, typename T, typename U>
-vector<N, T> operator/(vector<N, T> a, const U & b)
+VECMAT_CONSTEXPR
+typename std::enable_if<is_scalar<U>::value, vector<N, T>>::type
+operator/(vector<N, T> a, const U & b)
 {
     return a /= static_cast<T>(b);
 }
 template <size_t N, typename T>
-vector<N, T> operator/(vector<N, T> a, const vector<N, T> & b)
+VECMAT_CONSTEXPR vector<N, T> operator/(vector<N, T> a, const vector<N, T> & b)
 {
     return a /= b;
 }
@@ -305,18 +366,20 @@ vector<N, T> operator/(vector<N, T> a, const vector<N, T> & b)
  * of different lengths are never equal.
  */
 template <size_t N, size_t M, typename T>
+VECMAT_CONSTEXPR
 bool operator==(const vector<N, T> & a, const vector<M, T> & b)
 {
     if (M != N)
         return false;
 
     for (size_t i = 0; i < N; ++i)
-        if (a[i] != b[i])
+        if (a.data[i] != b.data[i])
             return false;
 
     return true;
 }
 template <size_t N, size_t M, typename T>
+VECMAT_CONSTEXPR
 bool operator!=(const vector<N, T> & a, const vector<M, T> & b)
 {
     return ! operator==(a, b);
@@ -329,12 +392,9 @@ bool operator!=(const vector<N, T> & a, const vector<M, T> & b)
  * convention is to call it the `dot product'
  */
 template <size_t N, typename T>
-T dot(const vector<N, T> & a, const vector<N, T> & b)
+VECMAT_CONSTEXPR T dot(const vector<N, T> & a, const vector<N, T> & b)
 {
-    T ret = 0;
-    for (size_t i = 0; i < N; i++)
-        ret += a[i] * b[i];
-    return ret;
+    return detail::inner<1>(a.data, b.data, detail::unrolled_t<N>());
 }
 
 /** ## Stream operators
@@ -442,15 +502,23 @@ enum rgba_t {R=0, G, B, A};
  * between 2 and 4, this throws std::out_of_range.
  */
 template <size_t N, size_t M, typename T>
-vector<3, T> cross(const vector<N, T> & a, const vector<M, T> & b)
+VECMAT_CONSTEXPR vector<3, T>
+cross(const vector<N, T> & a, const vector<M, T> & b)
 {
     if (N < 2 || 4 < N || M < 2 || 4 < M)
         throw std::out_of_range(__func__);
 
+    const T ax = a.data[X];
+    const T ay = a.data[Y];
+    const T az = detail::element<Z, N>(a.data);
+    const T bx = b.data[X];
+    const T by = b.data[Y];
+    const T bz = detail::element<Z, M>(b.data);
+
     vector<3, T> c {};
-    c[X] = a[Y] * (M > 2 ? b[Z] : 0) - (N > 2 ? a[Z] : 0) * b[Y];
-    c[Y] = (M > 2 ? a[Z] : 0) * b[X] - a[X] * (N > 2 ? b[Z] : 0);
-    c[Z] = a[X] * b[Y] - a[Y] * b[X];
+    c.data[X] = ay * bz - az * by;
+    c.data[Y] = az * bx - ax * bz;
+    c.data[Z] = ax * by - ay * bx;
     return c;
 }
 
@@ -464,12 +532,11 @@ vector<3, T> cross(const vector<N, T> & a, const vector<M, T> & b)
  * it, we can type cast the contents.
  */
 template <size_t N, typename T, size_t M, typename U>
-vecmat::vector<N, T> resize_cast(const vecmat::vector<M, U> & a)
+VECMAT_CONSTEXPR vecmat::vector<N, T>
+resize_cast(const vecmat::vector<M, U> & a)
 {
     vecmat::vector<N, T> b {};
-    for (size_t i = 0; i < N; ++i)
-        b[i] = static_cast<T>(i < M ? a[i] : 0);
-
+    detail::resize<N, M, 1>(b.data, a.data, detail::unrolled_t<N>());
     return b;
 }
 
@@ -0,0 +1,175 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/accumulate.hpp"
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+/** Every mode agrees with the fast path when the sums are exact
+ */
+template <typename T, typename Mode>
+int test_exact(const char * name, Mode mode)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::vector<37, T> a, b;
+    for (size_t i = 0; i < 37; ++i)
+    {
+        a[i] = static_cast<T>(static_cast<int>(i % 9) - 4);
+        b[i] = static_cast<T>(static_cast<int>(i % 4) - 1);
+    }
+    vecmat::matrix<6, 5, T> m;
+    for (size_t i = 0; i < 30; ++i)
+        m[i] = static_cast<T>(static_cast<int>(i % 5) - 2);
+    vecmat::dvector<T> d(3001), e(3001);
+    for (size_t i = 0; i < d.size(); ++i)
+    {
+        d[i] = static_cast<T>(static_cast<int>(i % 11) - 5);
+        e[i] = static_cast<T>(static_cast<int>(i % 3));
+    }
+    const vecmat::dmatrix<T> g(3, 2, {3, 4, 0, 0, 0, 0});
+
+    if (vecmat::dot(a, b, mode) != vecmat::dot(a, b) ||
+        vecmat::dot(d, e, mode) != vecmat::dot(d, e) ||
+        vecmat::sum(a, mode) != vecmat::sum(a) ||
+        vecmat::sum(m, mode) != vecmat::sum(m) ||
+        vecmat::sum(d, mode) != vecmat::sum(d) ||
+        vecmat::sum(g, mode) != vecmat::sum(g) ||
+        vecmat::norm(g, mode) != 5)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " disagrees with the fast path" << std::endl;
+    }
+
+    return success;
+}
+
+/** A long sum of numbers that are not exact in binary
+ *
+ * The reference is accumulated in `long double`.  The fast sum of a
+ * million floats loses about three digits; the accurate modes should
+ * keep close to full precision.
+ */
+template <typename Mode>
+double relative_error(Mode mode)
+{
+    const size_t n = 1 << 20;
+    vecmat::dvector<float> a(n);
+    long double exact = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = 0.1f + static_cast<float>(i % 1000) * 1.0e-4f;
+        exact += a[i];
+    }
+    const long double s = vecmat::sum(a, mode);
+    return static_cast<double>(std::fabs((s - exact) / exact));
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    if (test_exact<float>("fast", vecmat::fast_sum()) != EXIT_SUCCESS ||
+        test_exact<float>("pairwise", vecmat::pairwise_sum()) !=
+            EXIT_SUCCESS ||
+        test_exact<float>("compensated", vecmat::compensated_sum()) !=
+            EXIT_SUCCESS ||
+        test_exact<float>("widened", vecmat::widened_sum()) !=
+            EXIT_SUCCESS ||
+        test_exact<double>("pairwise", vecmat::pairwise_sum()) !=
+            EXIT_SUCCESS ||
+        test_exact<double>("compensated", vecmat::compensated_sum()) !=
+            EXIT_SUCCESS ||
+        test_exact<double>("widened", vecmat::widened_sum()) !=
+            EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    const double eps = 1.0 / (1 << 23);
+    const double pairwise = relative_error(vecmat::pairwise_sum());
+    const double compensated = relative_error(vecmat::compensated_sum());
+    const double widened = relative_error(vecmat::widened_sum());
+    if (pairwise > 16 * eps || compensated > eps || widened > eps)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Relative errors: fast "
+                  << relative_error(vecmat::fast_sum()) << ", pairwise "
+                  << pairwise << ", compensated " << compensated
+                  << ", widened " << widened << std::endl;
+    }
+
+    // Cancellation the fast sum cannot see
+    vecmat::vector<3, float> x = {1.0e8f, 1.0f, -1.0e8f};
+    vecmat::vector<3, float> y = {1.0f, 1.0f, 1.0f};
+    vecmat::dvector<float> z(1000, 0.0f);
+    z[10] = 1.0e8f;
+    z[500] = 1.0f;
+    z[990] = -1.0e8f;
+    if (vecmat::dot(x, y, vecmat::compensated_sum()) != 1.0f ||
+        vecmat::dot(x, y, vecmat::widened_sum()) != 1.0f ||
+        vecmat::sum(z, vecmat::compensated_sum()) != 1.0f ||
+        vecmat::sum(z, vecmat::widened_sum()) != 1.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "The accurate modes lost the cancellation"
+                  << std::endl;
+    }
+
+    // An infinite or overflowing sum stays infinite in the packed and
+    // scalar paths, and the widened norm survives an overflowing square
+    const float inf = std::numeric_limits<float>::infinity();
+    const float big = std::numeric_limits<float>::max();
+    vecmat::vector<3, float> u = {inf, 1.0f, 2.0f};
+    vecmat::vector<4, float> v = {1.0e20f, 1.0e20f, 1.0e20f, 1.0e20f};
+    vecmat::dvector<float> w(1000, 1.0f);
+    vecmat::dvector<float> o(1000, big);
+    w[3] = inf;
+    w[997] = inf;
+    const vecmat::compensated_sum cs;
+    if (vecmat::sum(u, cs) != inf || vecmat::dot(u, u, cs) != inf ||
+        vecmat::sum(w, cs) != inf || vecmat::dot(w, w, cs) != inf ||
+        vecmat::sum(o, cs) != inf || vecmat::dot(v, v, cs) != inf ||
+        vecmat::sum(-o, cs) != -inf || vecmat::norm(v, cs) != inf ||
+        vecmat::norm(v, vecmat::widened_sum()) != 2.0e20f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Infinite sums: " << vecmat::sum(u, cs) << ", "
+                  << vecmat::sum(w, cs) << ", " << vecmat::sum(o, cs)
+                  << ", " << vecmat::norm(v, cs) << ", "
+                  << vecmat::norm(v, vecmat::widened_sum()) << std::endl;
+    }
+
+    return success;
+}
@@ -0,0 +1,160 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/axpy.hpp"
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+/** Compare the in-place updates with the operators.  Small integers
+ * keep both exact.
+ */
+template <typename V>
+int test_updates(const char * name, V x, V y, V z)
+{
+    int success = EXIT_SUCCESS;
+
+    V e = y + x * 3;
+    if (axpy(3, x, y) != e)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " axpy failed" << std::endl;
+    }
+    e = x * 2 - y;
+    if (axpby(2, x, -1.0, y) != e || y != e)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " axpby failed" << std::endl;
+    }
+    e = z * 4;
+    if (scal(4, z) != e)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " scal failed" << std::endl;
+    }
+    e = x * y + z;
+    if (fma(x, y, z) != e)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " fma failed" << std::endl;
+    }
+
+    return success;
+}
+
+template <typename V>
+void fill(V & x, V & y, V & z, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        x[i] = static_cast<int>(i % 7) - 3;
+        y[i] = static_cast<int>(i % 5);
+        z[i] = static_cast<int>(i % 3) - 1;
+    }
+}
+
+template <typename T>
+int test_types(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::vector<37, T> a, b, c;
+    fill(a, b, c, 37);
+    if (test_updates("vector", a, b, c) != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    vecmat::matrix<5, 3, T> m, n, o;
+    fill(m, n, o, 15);
+    if (test_updates("matrix", m, n, o) != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    vecmat::dvector<T> u(1001), v(1001), w(1001);
+    fill(u, v, w, 1001);
+    if (test_updates("dvector", u, v, w) != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    vecmat::dmatrix<T> p(33, 17), q(33, 17), r(33, 17);
+    fill(p, q, r, 33 * 17);
+    if (test_updates("dmatrix", p, q, r) != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    if (test_types<float>() != EXIT_SUCCESS ||
+        test_types<double>() != EXIT_SUCCESS ||
+        test_types<int32_t>() != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    // A single rounding keeps the low bits a separate multiply loses
+    const double eps = std::ldexp(1.0, -30);
+    vecmat::vector<2, double> x = {1.0 + eps, 1.0 + eps};
+    vecmat::vector<2, double> y = {1.0 - eps, 1.0 - eps};
+    vecmat::vector<2, double> c = {-1.0, -1.0};
+    const vecmat::vector<2, double> d = fma(x, y, c);
+    if (d[0] != d[1] || (d[0] != 0.0 && d[0] != -eps * eps))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "fma rounded inconsistently: " << d << std::endl;
+    }
+
+    // Mismatched dynamic shapes
+    try
+    {
+        vecmat::dvector<float> u(3), v(4);
+        axpy(1.0f, u, v);
+        success = EXIT_FAILURE;
+        std::cout << "axpy accepted mismatched vectors" << std::endl;
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+    try
+    {
+        vecmat::dmatrix<float> p(3, 2), q(2, 3);
+        axpby(1.0f, p, 2.0f, q);
+        success = EXIT_FAILURE;
+        std::cout << "axpby accepted mismatched matrices" << std::endl;
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    return success;
+}
@@ -0,0 +1,141 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/gemm.hpp"
+#include "vecmat/gemv.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+/** Check the products on either side of the BLAS threshold against a
+ * plain loop.  Small integers keep the sums exact whichever library
+ * computes them.
+ */
+template <typename T>
+int test_products(size_t m, size_t n, size_t k)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::dmatrix<T> a(m, k), b(k, n);
+    for (size_t j = 0; j < k; ++j)
+        for (size_t i = 0; i < m; ++i)
+            a(i, j) = static_cast<T>((i + 2 * j) % 7) - 3;
+    for (size_t j = 0; j < n; ++j)
+        for (size_t i = 0; i < k; ++i)
+            b(i, j) = static_cast<T>((3 * i + j) % 5) - 2;
+    vecmat::dvector<T> x(k), z(m);
+    for (size_t i = 0; i < k; ++i)
+        x[i] = static_cast<T>(i % 3) - 1;
+    for (size_t i = 0; i < m; ++i)
+        z[i] = static_cast<T>(i % 4) - 2;
+
+    const vecmat::dmatrix<T> c = vecmat::dot(a, b);
+    const vecmat::dvector<T> y = vecmat::dot(a, x);
+    const vecmat::dvector<T> w = vecmat::dot(z, a);
+    for (size_t j = 0; j < n && success == EXIT_SUCCESS; ++j)
+        for (size_t i = 0; i < m; ++i)
+        {
+            T e = 0;
+            for (size_t l = 0; l < k; ++l)
+                e += a(i, l) * b(l, j);
+            if (c(i, j) != e)
+            {
+                success = EXIT_FAILURE;
+                std::cout << "The " << m << "x" << k << " by " << k << "x"
+                          << n << " product failed at (" << i << ", "
+                          << j << ")" << std::endl;
+                break;
+            }
+        }
+    for (size_t i = 0; i < m; ++i)
+    {
+        T e = 0;
+        for (size_t l = 0; l < k; ++l)
+            e += a(i, l) * x[l];
+        if (y[i] != e)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "The " << m << "x" << k
+                      << " matrix-vector product failed at " << i
+                      << std::endl;
+            break;
+        }
+    }
+    for (size_t j = 0; j < k; ++j)
+    {
+        T e = 0;
+        for (size_t l = 0; l < m; ++l)
+            e += z[l] * a(l, j);
+        if (w[j] != e)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "The " << m << "x" << k
+                      << " vector-matrix product failed at " << j
+                      << std::endl;
+            break;
+        }
+    }
+
+    // The transposed operands of the strided form
+    std::vector<T> at(k * m), ct(m * n);
+    for (size_t j = 0; j < k; ++j)
+        for (size_t i = 0; i < m; ++i)
+            at[j + i * k] = a(i, j);
+    vecmat::gemm(true, false, m, n, k, at.data(), k, b.data(), k,
+                 ct.data(), m);
+    for (size_t i = 0; i < m * n; ++i)
+        if (ct[i] != c.data()[i])
+        {
+            success = EXIT_FAILURE;
+            std::cout << "The transposed " << m << "x" << k
+                      << " product failed at " << i << std::endl;
+            break;
+        }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    // Below, at, and well above the default threshold
+    const size_t sizes[][3] = {{3, 5, 7}, {40, 40, 40}, {64, 64, 64},
+                               {129, 67, 80}, {300, 2, 500}};
+    for (const size_t * s: sizes)
+        if (test_products<float>(s[0], s[1], s[2]) != EXIT_SUCCESS ||
+            test_products<double>(s[0], s[1], s[2]) != EXIT_SUCCESS ||
+            test_products<int>(s[0], s[1], s[2]) != EXIT_SUCCESS)
+            success = EXIT_FAILURE;
+
+    return success;
+}
@@ -0,0 +1,76 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/vector.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+/** This test is built with `VECMAT_BOUNDS_CHECK` set to
+ * `VECMAT_BOUNDS_ABORT`, so reaching the end of `main` after an out of
+ * range access is the failure.
+ */
+static volatile std::sig_atomic_t success = EXIT_SUCCESS;
+
+extern "C" void aborted(int)
+{
+    std::_Exit(success);
+}
+
+int main(void)
+{
+#if VECMAT_BOUNDS_CHECK != VECMAT_BOUNDS_ABORT
+    std::cout << "Built with the wrong bounds check policy" << std::endl;
+    success = EXIT_FAILURE;
+#endif
+
+    vecmat::vector<3, int> a {{1, 2, 3}};
+    vecmat::matrix<2, 3, int> b {{1, 2, 3, 4, 5, 6}};
+    vecmat::dvector<int> c {1, 2, 3};
+    vecmat::dmatrix<int> d(2, 3, {1, 2, 3, 4, 5, 6});
+    if (a[2] != 3 || a(0) != 1 || b[5] != 6 || b(1, 2) != 6 ||
+        c[2] != 3 || d(1, 2) != 6)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "In range access failed" << std::endl;
+    }
+
+    // Keep the index opaque so the access cannot be folded away
+    volatile size_t opaque = 2;
+    const size_t i = opaque;
+    std::signal(SIGABRT, aborted);
+    std::cout << b(i, 0) << std::endl;
+
+    std::cout << "Out of range access did not abort" << std::endl;
+    return EXIT_FAILURE;
+}
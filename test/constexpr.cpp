@@ -0,0 +1,115 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/matrix.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+#if VECMAT_HAS_CONSTEXPR
+/** Quarter turns about z, built entirely at compile time
+ */
+template <typename T>
+constexpr vecmat::mat4<T> quarter_turn(void)
+{
+    vecmat::mat4<T> r = vecmat::eye<4, T>();
+    r(0, 0) = 0;
+    r(1, 1) = 0;
+    r(0, 1) = -1;
+    r(1, 0) = 1;
+    return r;
+}
+
+template <typename T>
+constexpr vecmat::mat4<T> turns(size_t n)
+{
+    vecmat::mat4<T> r = vecmat::eye<4, T>();
+    for (size_t i = 0; i < n; ++i)
+        r = vecmat::dot(quarter_turn<T>(), r);
+    return r;
+}
+
+/** A product too large to unroll */
+constexpr vecmat::matrix<9, 9, double> scaled_eye(void)
+{
+    vecmat::matrix<9, 9, double> a = vecmat::eye<9, double>();
+    a *= 2.0;
+    a += vecmat::eye<9, double>();
+    return vecmat::dot(a, vecmat::eye<9, double>()) / 3.0;
+}
+
+static constexpr vecmat::mat4<float> table[] = {
+    turns<float>(0), turns<float>(1), turns<float>(2), turns<float>(3)};
+
+static constexpr vecmat::vec3<double> e0 = {1.0, 0.0, 0.0};
+static constexpr vecmat::vec3<double> e1 = {0.0, 1.0, 0.0};
+static constexpr vecmat::vec3<double> e2 = vecmat::cross(e0, e1);
+static_assert(e2[0] == 0.0 && e2[1] == 0.0 && e2[2] == 1.0,
+              "cross product");
+static_assert(vecmat::dot(e0 + 2.0 * e1, e1 - e0) == 1.0, "dot product");
+static_assert(-e0 == e0 * -1.0 && e0 != e1, "comparison");
+
+static constexpr vecmat::vec4<float> p =
+    vecmat::resize_cast<4, float>(e0 + e1 + e2);
+static_assert(p[3] == 0.0f && p[2] == 1.0f, "resize cast");
+static_assert(vecmat::dot(table[1], p)[0] == -1.0f, "mat4 vec4 product");
+static_assert(vecmat::dot(table[2], table[2]) == table[0],
+              "mat4 product");
+static_assert(vecmat::dot(p, table[3]) == vecmat::dot(table[1], p),
+              "vec4 mat4 product");
+static_assert(scaled_eye() == vecmat::eye<9, double>(), "large product");
+static_assert(vecmat::resize_cast<2, 2, int>(table[1])(0, 1) == -1,
+              "matrix resize cast");
+#endif
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+#if VECMAT_HAS_CONSTEXPR
+    // The tables must agree with the same products done at run time
+    vecmat::mat4<float> r = vecmat::eye<4, float>();
+    const vecmat::mat4<float> q = quarter_turn<float>();
+    for (size_t i = 0; i < 4; ++i)
+    {
+        if (r != table[i])
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Table entry " << i << " failed: " << table[i]
+                      << std::endl;
+        }
+        r = vecmat::dot(q, r);
+    }
+#else
+    std::cout << "Compile time evaluation is not available" << std::endl;
+#endif
+
+    return success;
+}
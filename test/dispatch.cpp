@@ -0,0 +1,175 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/batch.hpp"
+#include "vecmat/dispatch.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/transform.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#if defined(VECMAT_DISPATCH_X86)
+
+/** Run every dispatched kernel for one type at the selected level and
+ * compare with plain loops.  Small integers and power of two divisors
+ * keep the results exact whatever the order of the operations.
+ */
+template <typename T>
+int test_kernels(const char * name, size_t n)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::dvector<T> a(n), b(n);
+    T expected = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = static_cast<T>(i % 13) - 6;
+        b[i] = static_cast<T>(1 << (i % 3));
+        expected += a[i] * b[i];
+    }
+    if (vecmat::dot(a, b) != expected)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " dot of " << n << " failed" << std::endl;
+    }
+
+    vecmat::dvector<T> c = a;
+    c += b;
+    c *= b;
+    c -= a;
+    c /= b;
+    c *= T(4);
+    c += T(3);
+    c -= T(1);
+    c /= T(2);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const T e = (((a[i] + b[i]) * b[i] - a[i]) / b[i] * 4 + 3 - 1) / 2;
+        if (c[i] != e)
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " element-wise ops of " << n
+                      << " failed at " << i << ": " << c[i]
+                      << " != " << e << std::endl;
+            break;
+        }
+    }
+
+    const vecmat::matrix<4, 4, T> m = {
+        2, 0, 1, 1,
+        0, 3, 0, -1,
+        1, 0, 1, 2,
+        4, 5, 6, 20};
+    std::vector<vecmat::vector<4, T> > p(n), q(n);
+    for (size_t i = 0; i < n; ++i)
+        p[i] = {a[i], b[i], static_cast<T>(i % 5), 1};
+    vecmat::transform(m, p.data(), q.data(), n);
+    vecmat::vector_batch<4, T> s =
+        vecmat::transform(m, vecmat::to_soa(p.data(), n));
+    vecmat::vector_batch<3, T> s3(n);
+    for (size_t i = 0; i < n; ++i)
+        s3[i] = vecmat::resize_cast<3, T>(p[i]);
+    s3 = vecmat::transform(m, s3);
+    vecmat::transform(m, p.data(), p.data(), n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const vecmat::vector<4, T> e = q[i];
+        if (p[i] != e || vecmat::vector<4, T>(s[i]) != e ||
+            vecmat::vector<3, T>(s3[i]) != vecmat::resize_cast<3, T>(e))
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " transform of " << n
+                      << " points failed at " << i << ": " << p[i]
+                      << " != " << e << std::endl;
+            break;
+        }
+    }
+    p.assign(q.size(), vecmat::vector<4, T>());
+    for (size_t i = 0; i < n; ++i)
+        p[i] = {a[i], b[i], static_cast<T>(i % 5), 1};
+    for (size_t i = 0; i < n; ++i)
+        if (vecmat::dot(m, p[i]) != q[i])
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " transform of " << n
+                      << " points differs from the product at " << i
+                      << std::endl;
+            break;
+        }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    const vecmat::isa_t levels[] = {vecmat::isa_baseline, vecmat::isa_avx2,
+                                    vecmat::isa_avx512};
+    const char * names[] = {"baseline", "avx2", "avx512"};
+    for (size_t k = 0; k < 3; ++k)
+    {
+        if (levels[k] > vecmat::detected_isa())
+            break;
+        if (vecmat::set_isa(levels[k]) != levels[k] ||
+            vecmat::active_isa() != levels[k])
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Selecting " << names[k] << " failed" << std::endl;
+        }
+        const size_t sizes[] = {1, 7, 63, 64, 65, 100, 1000};
+        for (size_t n: sizes)
+            if (test_kernels<float>(names[k], n) != EXIT_SUCCESS ||
+                test_kernels<double>(names[k], n) != EXIT_SUCCESS)
+                success = EXIT_FAILURE;
+    }
+
+    // Asking for more than the processor has gets what it has
+    if (vecmat::set_isa(vecmat::isa_avx512) != vecmat::detected_isa())
+    {
+        success = EXIT_FAILURE;
+        std::cout << "The level was raised above the processor" << std::endl;
+    }
+
+    return success;
+}
+
+#else
+
+int main(void)
+{
+    std::cout << "Run time dispatch is not available" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/matrix.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::dmatrix<float> a(3, 3, {2.0, 9.0, 4.0,
+                                    7.0, 5.0, 3.0,
+                                    6.0, 1.0, 8.0});
+    vecmat::dmatrix<float> b(3, 3, {1.0, 0.0, 0.0,
+                                    0.0, 2.0, 0.0,
+                                    0.0, 0.0, 3.0});
+    if (a(1, 0) != 9.0 || a(0, 1) != 7.0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Elements are not column-major" << std::endl;
+    }
+    if (reinterpret_cast<uintptr_t>(a.data()) % 64 != 0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Storage is not 64 byte aligned" << std::endl;
+    }
+
+    vecmat::dmatrix<float> c = vecmat::dot(a, b);
+    vecmat::dmatrix<float> d1(3, 3, { 2.0,  9.0,  4.0,
+                                     14.0, 10.0,  6.0,
+                                     18.0,  3.0, 24.0});
+    if (c != d1)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Matrix multiplication failed [" << c << "]"
+            << std::endl;
+    }
+
+    vecmat::dvector<float> v {1.0, 2.0, 3.0};
+    if (vecmat::dot(a, v) != vecmat::dvector<float> {34, 22, 34})
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Matrix-vector multiplication failed" << std::endl;
+    }
+    if (vecmat::dot(v, a) != vecmat::dvector<float> {32, 26, 32})
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Vector-matrix multiplication failed" << std::endl;
+    }
+
+    // Agree with the fixed size product on a large, rectangular case
+    static vecmat::matrix<70, 40, double> f;
+    static vecmat::matrix<40, 90, double> g;
+    for (size_t i = 0; i < 70 * 40; ++i)
+        f[i] = static_cast<double>(i % 11) - 5.0;
+    for (size_t i = 0; i < 40 * 90; ++i)
+        g[i] = static_cast<double>(i % 7) - 3.0;
+    vecmat::dmatrix<double> h = vecmat::dot(vecmat::dmatrix<double>(f),
+                                            vecmat::dmatrix<double>(g));
+    if (vecmat::resize_cast<70, 90, double>(h) != vecmat::dot(f, g))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Large product disagrees with fixed size"
+            << std::endl;
+    }
+
+    vecmat::dmatrix<float> e = 2 * a - b;
+    const float * p = e.data();
+    e = std::move(e) + a;
+    if (e.data() != p || e != 3 * a - b)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Temporary was not reused" << std::endl;
+    }
+
+    try
+    {
+        vecmat::dot(a, vecmat::dmatrix<float>(2, 3));
+        success = EXIT_FAILURE;
+        std::cout << "Dimension mismatch did not throw" << std::endl;
+    }
+    catch (const std::out_of_range &)
+    {
+        // This is expected
+    }
+
+    vecmat::dmatrix<int> k = vecmat::resize_cast<int>(a, 2, 4);
+    vecmat::dmatrix<int> k1(2, 4, {2, 9, 7, 5, 6, 1, 0, 0});
+    if (k != k1)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Dynamic cast failed [" << k << "]" << std::endl;
+    }
+    vecmat::matrix<2, 2, int> l = vecmat::resize_cast<2, 2, int>(a);
+    if (l != vecmat::matrix<2, 2, int> {{2, 9, 7, 5}})
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Dynamic to fixed cast failed" << std::endl;
+    }
+
+    std::stringstream ss;
+    ss << b;
+    vecmat::dmatrix<float> r(3, 3);
+    ss >> r;
+    if (r != b)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Stream round trip failed [" << r << "]" << std::endl;
+    }
+
+    return success;
+}
@@ -0,0 +1,163 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/dvector.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::dvector<double> a(1000);
+    if (a.size() != 1000)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Length was " << a.size() << std::endl;
+    }
+    for (auto x: a)
+        if (x != 0)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "An initialization value was not 0" << std::endl;
+            break;
+        }
+    if (reinterpret_cast<uintptr_t>(a.data()) % 64 != 0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Storage is not 64 byte aligned" << std::endl;
+    }
+
+    for (size_t i = 0; i < a.size(); ++i)
+        a[i] = static_cast<double>(i);
+    vecmat::dvector<double> b(a.size(), 2.0);
+
+    vecmat::dvector<double> c = 3.0 * a + b / 2.0 - 1.0;
+    for (size_t i = 0; i < c.size(); ++i)
+        if (c[i] != 3.0 * i)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Chained arithmetic failed at " << i << std::endl;
+            break;
+        }
+
+    // Temporaries donate their storage to the result
+    vecmat::dvector<double> d = a * b;
+    const double * p = d.data();
+    vecmat::dvector<double> e = std::move(d) - a;
+    if (e.data() != p || e != a)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Left temporary was not reused" << std::endl;
+    }
+    p = e.data();
+    vecmat::dvector<double> f = b + std::move(e);
+    if (f.data() != p)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Right temporary was not reused" << std::endl;
+    }
+    p = f.data();
+    f = -std::move(f);
+    if (f.data() != p || f != -(a + b))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "In place negation failed" << std::endl;
+    }
+
+    vecmat::dvector<float> g {0.0, 1.0, 2.0, 3.0, 4.0};
+    if (vecmat::dot(g, g) != 1.0 + 4.0 + 9.0 + 16.0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Dot product failed" << std::endl;
+    }
+
+    try
+    {
+        vecmat::dvector<float> h(4);
+        h += g;
+        success = EXIT_FAILURE;
+        std::cout << "Length mismatch did not throw" << std::endl;
+    }
+    catch (const std::out_of_range &)
+    {
+        // This is expected
+    }
+
+    // Interoperate with the fixed size vectors
+    vecmat::vector<3, float> v {{1.0, 2.0, 3.0}};
+    vecmat::dvector<float> w = v;
+    if (w.size() != 3 || w[2] != 3.0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Conversion from a fixed vector failed" << std::endl;
+    }
+    vecmat::dvector<int> x = vecmat::resize_cast<int>(v, 5);
+    if (x != vecmat::dvector<int> {1, 2, 3, 0, 0})
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Fixed to dynamic cast failed [" << x << "]"
+            << std::endl;
+    }
+    vecmat::vector<2, double> y = vecmat::resize_cast<2, double>(x);
+    if (y != vecmat::vector<2, double> {{1.0, 2.0}})
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Dynamic to fixed cast failed" << std::endl;
+    }
+    vecmat::dvector<float> z = vecmat::resize_cast<float>(x, 2);
+    if (z != vecmat::dvector<float> {1.0, 2.0})
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Dynamic to dynamic cast failed" << std::endl;
+    }
+
+    std::stringstream ss;
+    ss << g;
+    if (ss.str() != "0, 1, 2, 3, 4")
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Output failed [" << ss.str() << "]" << std::endl;
+    }
+    vecmat::dvector<float> r(5);
+    ss >> r;
+    if (r != g)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Input failed [" << r << "]" << std::endl;
+    }
+
+    return success;
+}
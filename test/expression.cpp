@@ -0,0 +1,137 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/expression.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+static const size_t N = 37;
+
+template <typename T>
+int check_vector(const char * name)
+{
+    int success = EXIT_SUCCESS;
+    vecmat::vector<N, T> a {}, b {}, c {};
+    for (size_t i = 0; i < N; ++i)
+    {
+        a[i] = static_cast<T>(i + 1);
+        b[i] = static_cast<T>(2 * i + 3);
+        c[i] = static_cast<T>(i % 5 + 1);
+    }
+
+    vecmat::vector<N, T> d;
+    d = vecmat::lazy(a) * 3 + b * 2 - c;
+    if (d != a * 3 + b * 2 - c)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " chained vector expression failed"
+            << std::endl;
+    }
+
+    d = 2 - vecmat::lazy(a) / c;
+    if (d != 2 - a / c)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " division expression failed" << std::endl;
+    }
+
+    d = -(vecmat::lazy(a) + 1) * b;
+    if (d != -(a + 1) * b)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " negation expression failed" << std::endl;
+    }
+
+    d = a;
+    d += vecmat::lazy(b) * c;
+    if (d != a + b * c)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " compound expression failed" << std::endl;
+    }
+
+    auto e = vecmat::eval(c + vecmat::lazy(a) - b);
+    if (e != c + a - b)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " eval failed" << std::endl;
+    }
+
+    return success;
+}
+
+template <typename T>
+int check_matrix(const char * name)
+{
+    int success = EXIT_SUCCESS;
+    vecmat::matrix<5, 7, T> a {}, b {};
+    for (size_t i = 0; i < 35; ++i)
+    {
+        a[i] = static_cast<T>(i);
+        b[i] = static_cast<T>(35 - i);
+    }
+
+    vecmat::matrix<5, 7, T> c;
+    c = vecmat::lazy(a) * 2 - vecmat::lazy(b) * 4 + 1;
+    if (c != a * 2 - b * 4 + 1)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " matrix expression failed" << std::endl;
+    }
+
+    c -= a * vecmat::lazy(b);
+    if (c != a * 2 - b * 4 + 1 - a * b)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " matrix compound expression failed"
+            << std::endl;
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+    if (check_vector<float>("float") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check_vector<double>("double") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check_vector<int>("int") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check_matrix<float>("float") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check_matrix<long>("long") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    return success;
+}
@@ -0,0 +1,52 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** Assigning an expression of another shape must not compile
+ *
+ * The build of this file is the test: it is expected to fail on the
+ * shape check, with `VECMAT_SHAPE_MATRIX` selecting the matrix case.
+ */
+
+#include "vecmat/expression.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+
+int main(void)
+{
+#if defined(VECMAT_SHAPE_MATRIX)
+    vecmat::matrix<2, 3, float> a {};
+    a = vecmat::lazy(vecmat::matrix<3, 2, float> {}) + 1.0f;
+#else
+    vecmat::vector<4, float> a {};
+    a = vecmat::lazy(vecmat::vector<16, float> {}) + 1.0f;
+#endif
+    return a[0] == 1 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
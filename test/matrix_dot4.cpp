@@ -0,0 +1,101 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/matrix.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+template <typename T>
+int check(const char * name)
+{
+    int success = EXIT_SUCCESS;
+    vecmat::mat4<T> a {};
+    vecmat::mat4<T> b {};
+    for (size_t i = 0; i < 16; ++i)
+    {
+        a[i] = static_cast<T>(i + 1);
+        b[i] = static_cast<T>(2 * i % 7) - static_cast<T>(3);
+    }
+
+    // Compare against the generic loop
+    vecmat::mat4<T> c = vecmat::dot(a, b);
+    for (size_t j = 0; j < 4; ++j)
+        for (size_t i = 0; i < 4; ++i)
+        {
+            T x = 0;
+            for (size_t k = 0; k < 4; ++k)
+                x += a(i, k) * b(k, j);
+            if (x != c(i, j))
+            {
+                success = EXIT_FAILURE;
+                std::cout << name << " matrix product failed at (" << i
+                    << ", " << j << ") " << c(i, j) << " versus " << x
+                    << std::endl;
+            }
+        }
+
+    vecmat::mat4<T> I = vecmat::eye<4, T>();
+    if (vecmat::dot(I, a) != a || vecmat::dot(a, I) != a)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " identity product failed" << std::endl;
+    }
+
+    vecmat::vec4<T> v {{1, -2, 3, 1}};
+    vecmat::vec4<T> w = vecmat::dot(a, v);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        T x = 0;
+        for (size_t k = 0; k < 4; ++k)
+            x += a(i, k) * v(k);
+        if (x != w(i))
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " matrix-vector product failed at " << i
+                << " " << w(i) << " versus " << x << std::endl;
+        }
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+    if (check<float>("float") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check<double>("double") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check<int>("int") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    return success;
+}
@@ -0,0 +1,135 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/gemm.hpp"
+#include "vecmat/matrix.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Fill with small integers so every product is exact
+template <typename T>
+void fill(std::vector<T> & a, size_t seed)
+{
+    for (size_t i = 0; i < a.size(); ++i)
+        a[i] = static_cast<T>((i * 7 + seed) % 11) - static_cast<T>(5);
+}
+
+template <typename T>
+int check(const char * name, size_t m, size_t n, size_t k, size_t pad)
+{
+    const size_t lda = m + pad;
+    const size_t ldb = k + pad;
+    const size_t ldc = m + pad;
+    std::vector<T> a(lda * k), b(ldb * n), c(ldc * n, 42);
+    fill(a, 1);
+    fill(b, 2);
+
+    vecmat::gemm(m, n, k, a.data(), lda, b.data(), ldb, c.data(), ldc);
+    for (size_t j = 0; j < n; ++j)
+        for (size_t i = 0; i < m; ++i)
+        {
+            T x = 0;
+            for (size_t p = 0; p < k; ++p)
+                x += a[i + p * lda] * b[p + j * ldb];
+            if (x != c[i + j * ldc])
+            {
+                std::cout << name << " " << m << "x" << k << " times "
+                    << k << "x" << n << " failed at (" << i << ", " << j
+                    << ") " << c[i + j * ldc] << " versus " << x
+                    << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+    // The padding must be left alone
+    for (size_t j = 0; j < n; ++j)
+        for (size_t i = m; i < ldc; ++i)
+            if (c[i + j * ldc] != 42)
+            {
+                std::cout << name << " wrote into the padding"
+                    << std::endl;
+                return EXIT_FAILURE;
+            }
+
+    return EXIT_SUCCESS;
+}
+
+template <typename T>
+int check_all(const char * name)
+{
+    int success = EXIT_SUCCESS;
+    const size_t sizes[][3] = {{1, 1, 1}, {5, 3, 7}, {33, 31, 29},
+                               {67, 71, 45}, {150, 13, 300},
+                               {17, 200, 260}};
+    for (auto & s: sizes)
+        for (size_t pad = 0; pad < 5; pad += 3)
+            if (check<T>(name, s[0], s[1], s[2], pad) != EXIT_SUCCESS)
+                success = EXIT_FAILURE;
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+    if (check_all<float>("float") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check_all<double>("double") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check_all<int>("int") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check_all<long>("long") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    // Large enough for the fixed size product to take the blocked path
+    static vecmat::matrix<67, 45, double> a;
+    static vecmat::matrix<45, 71, double> b;
+    for (size_t i = 0; i < 67 * 45; ++i)
+        a[i] = static_cast<double>(i % 13) - 6.0;
+    for (size_t i = 0; i < 45 * 71; ++i)
+        b[i] = static_cast<double>(i % 5) - 2.0;
+    vecmat::matrix<67, 71, double> c = vecmat::dot(a, b);
+    for (size_t j = 0; j < 71; ++j)
+        for (size_t i = 0; i < 67; ++i)
+        {
+            double x = 0;
+            for (size_t p = 0; p < 45; ++p)
+                x += a(i, p) * b(p, j);
+            if (x != c(i, j))
+            {
+                std::cout << "67x45 times 45x71 failed at (" << i << ", "
+                    << j << ")" << std::endl;
+                success = EXIT_FAILURE;
+            }
+        }
+
+    return success;
+}
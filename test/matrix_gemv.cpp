@@ -0,0 +1,145 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/gemv.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/thread_pool.hpp"
+#include "vecmat/transpose.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+/** Check both products of an `m` by `n` array against plain loops
+ *
+ * Small integers keep every sum exact regardless of the order.
+ */
+template <typename T>
+int test_gemv(size_t m, size_t n)
+{
+    int success = EXIT_SUCCESS;
+
+    const size_t lda = m + 3;
+    std::vector<T> a(lda * n);
+    std::vector<T> x(n);
+    std::vector<T> z(m);
+    for (size_t k = 0; k < a.size(); ++k)
+        a[k] = static_cast<T>(static_cast<int>(k % 7) - 3);
+    for (size_t j = 0; j < n; ++j)
+        x[j] = static_cast<T>(j % 5);
+    for (size_t i = 0; i < m; ++i)
+        z[i] = static_cast<T>(static_cast<int>(i % 3) - 1);
+
+    std::vector<T> y(m, static_cast<T>(-7));
+    vecmat::gemv(false, m, n, a.data(), lda, x.data(), y.data());
+    for (size_t i = 0; i < m; ++i)
+    {
+        T e = 0;
+        for (size_t j = 0; j < n; ++j)
+            e += a[i + j * lda] * x[j];
+        if (y[i] != e)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "A x failed for " << m << "x" << n << " at " << i
+                      << std::endl;
+            break;
+        }
+    }
+
+    std::vector<T> w(n, static_cast<T>(-7));
+    vecmat::gemv(true, m, n, a.data(), lda, z.data(), w.data());
+    for (size_t j = 0; j < n; ++j)
+    {
+        T e = 0;
+        for (size_t i = 0; i < m; ++i)
+            e += a[i + j * lda] * z[i];
+        if (w[j] != e)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "A' x failed for " << m << "x" << n << " at " << j
+                      << std::endl;
+            break;
+        }
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    // Shapes around the pack width and the four column blocking
+    const size_t sizes[] = {1, 3, 4, 7, 17, 33, 100};
+    for (size_t m : sizes)
+        for (size_t n : sizes)
+            if (test_gemv<float>(m, n) != EXIT_SUCCESS ||
+                test_gemv<double>(m, n) != EXIT_SUCCESS ||
+                test_gemv<int>(m, n) != EXIT_SUCCESS)
+                success = EXIT_FAILURE;
+
+    // Large enough to split across the pool
+    vecmat::set_num_threads(3);
+    if (test_gemv<float>(1001, 700) != EXIT_SUCCESS ||
+        test_gemv<double>(600, 1003) != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    vecmat::set_num_threads(1);
+
+    // The fixed, runtime, and view forms of dot all agree
+    vecmat::matrix<9, 6, double> a;
+    for (size_t k = 0; k < 54; ++k)
+        a[k] = static_cast<double>(k % 5);
+    vecmat::vector<6, double> x = {1.0, -1.0, 2.0, 0.0, 3.0, 1.0};
+    vecmat::vector<9, double> y = {1.0, 2.0, 3.0, 4.0, 5.0,
+                                   6.0, 7.0, 8.0, 9.0};
+    const vecmat::vector<9, double> ax = vecmat::dot(a, x);
+    const vecmat::vector<6, double> ya = vecmat::dot(y, a);
+    const vecmat::matrix<6, 9, double> at = vecmat::transpose_copy(a);
+    if (vecmat::dot(vecmat::transpose(a), y) != ya ||
+        vecmat::dot(x, vecmat::transpose(a)) != ax ||
+        vecmat::dot(at, y) != ya || vecmat::dot(x, at) != ax)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Transposed products disagree" << std::endl;
+    }
+    vecmat::dmatrix<double> d(a);
+    if (vecmat::dot(d, vecmat::dvector<double>(x)) !=
+        vecmat::dvector<double>(ax) ||
+        vecmat::dot(vecmat::dvector<double>(y), d) !=
+        vecmat::dvector<double>(ya))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Runtime sized products disagree" << std::endl;
+    }
+
+    return success;
+}
@@ -0,0 +1,129 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/map.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    // A 3x2 block of a column-major 5x4 array
+    double buffer[20];
+    for (size_t k = 0; k < 20; ++k)
+        buffer[k] = static_cast<double>(k);
+    vecmat::matrix_map<3, 2, double> a = vecmat::map<3, 2>(buffer + 1, 5);
+
+    if (a(0, 0) != 1.0 || a(2, 1) != 8.0 || a[3] != 6.0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Element access did not honor the leading dimension"
+                  << std::endl;
+    }
+
+    vecmat::matrix<3, 2, double> b = a;
+    vecmat::matrix<3, 2, double> expect = {1.0, 2.0, 3.0, 6.0, 7.0, 8.0};
+    if (b != expect || a != expect)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Conversion failed:\n" << b << std::endl;
+    }
+
+    // Compound assignment leaves the rest of the array alone
+    a += 100.0;
+    if (buffer[0] != 0.0 || buffer[1] != 101.0 || buffer[4] != 4.0 ||
+        buffer[5] != 5.0 || buffer[8] != 108.0 || buffer[9] != 9.0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Compound assignment touched the wrong elements"
+                  << std::endl;
+    }
+    a -= b + 100.0;
+    if (a != vecmat::matrix<3, 2, double>())
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Mixed compound assignment failed" << std::endl;
+    }
+    a = b;
+    if (buffer[1] != 1.0 || buffer[8] != 8.0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Assignment did not write through" << std::endl;
+    }
+
+    // Products read the operands in place
+    vecmat::matrix<2, 3, double> c = {1.0, 0.0, 0.0, 1.0, 1.0, 1.0};
+    vecmat::matrix<3, 3, double> d = vecmat::dot(a, c);
+    if (d != vecmat::dot(b, c))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Matrix product failed:\n" << d << std::endl;
+    }
+    vecmat::matrix_map<2, 3, const double> cm(c);
+    if (vecmat::dot(a, cm) != d || vecmat::dot(b, cm) != d)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Product of two maps failed" << std::endl;
+    }
+
+    vecmat::vector<2, double> x = {1.0, 2.0};
+    vecmat::vector<3, double> y = {1.0, 1.0, 1.0};
+    if (vecmat::dot(a, x) != vecmat::dot(b, x) ||
+        vecmat::dot(y, a) != vecmat::dot(y, b))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Matrix vector product failed" << std::endl;
+    }
+
+    // Large enough to go through the blocked kernel
+    const size_t n = 64;
+    double * big = new double[(n + 3) * n];
+    for (size_t k = 0; k < (n + 3) * n; ++k)
+        big[k] = static_cast<double>(k % 7);
+    vecmat::matrix_map<64, 64, const double> e(big, n + 3);
+    vecmat::matrix<64, 64, double> f = e;
+    if (vecmat::dot(e, e) != vecmat::dot(f, f))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Large mapped product failed" << std::endl;
+    }
+    delete[] big;
+
+    if (2.0 * a != a * 2.0 || (a - b) != vecmat::matrix<3, 2, double>())
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Binary operators failed" << std::endl;
+    }
+
+    return success;
+}
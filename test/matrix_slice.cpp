@@ -0,0 +1,139 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/matrix.hpp"
+#include "vecmat/slice.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    // A rigid transform: rotate a quarter turn about z, then translate
+    vecmat::matrix<4, 4, float> m = {
+         0.0f, 1.0f, 0.0f, 0.0f,
+        -1.0f, 0.0f, 0.0f, 0.0f,
+         0.0f, 0.0f, 1.0f, 0.0f,
+         1.0f, 2.0f, 3.0f, 1.0f};
+
+    vecmat::vector<4, float> t = vecmat::col(m, 3);
+    vecmat::vector<4, float> expect = {1.0f, 2.0f, 3.0f, 1.0f};
+    if (t != expect)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Translation column was " << t << std::endl;
+    }
+
+    vecmat::vector<4, float> r = vecmat::row(m, 0);
+    expect = {0.0f, -1.0f, 0.0f, 1.0f};
+    if (r != expect)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "First row was " << r << std::endl;
+    }
+
+    // The upper left 3x3 rotates without touching the translation
+    vecmat::vector<3, float> x = {1.0f, 0.0f, 0.0f};
+    vecmat::vector<3, float> y = vecmat::dot(vecmat::block<3, 3>(m, 0, 0), x);
+    vecmat::vector<3, float> ey = {0.0f, 1.0f, 0.0f};
+    if (y != ey)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Rotated x was " << y << std::endl;
+    }
+    vecmat::vector<3, float> p = vecmat::col(vecmat::block<3, 4>(m, 0, 0), 3);
+    vecmat::vector<3, float> ep = {1.0f, 2.0f, 3.0f};
+    if (p + y != ep + ey)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Block arithmetic failed" << std::endl;
+    }
+
+    // Slices write through to the parent
+    vecmat::col(m, 3) *= 2.0f;
+    if (m(0, 3) != 2.0f || m(3, 3) != 2.0f || m(0, 2) != 0.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Column update did not write through" << std::endl;
+    }
+    vecmat::row(m, 3) = vecmat::vector<4, float>{0.0f, 0.0f, 0.0f, 1.0f};
+    if (m(3, 3) != 1.0f || m(2, 3) != 6.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Row assignment did not write through" << std::endl;
+    }
+    vecmat::block<2, 2>(m, 2, 2) = 5.0f;
+    if (m(2, 2) != 5.0f || m(3, 3) != 5.0f || m(1, 1) != 0.0f ||
+        m(2, 1) != 0.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Block assignment did not write through" << std::endl;
+    }
+
+    // Slices of slices keep the parent's leading dimension
+    vecmat::matrix_map<3, 3, float> b = vecmat::block<3, 3>(m, 1, 1);
+    if (vecmat::col(b, 1)[1] != 5.0f || vecmat::row(b, 0)[2] != 4.0f ||
+        vecmat::block<1, 1>(b, 2, 2)(0, 0) != 5.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Nested slices failed" << std::endl;
+    }
+
+    const vecmat::matrix<4, 4, float> & c = m;
+    if (vecmat::dot(vecmat::row(c, 0), vecmat::col(c, 0)) != -1.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Dot of slices failed" << std::endl;
+    }
+
+    try
+    {
+        vecmat::col(m, 4);
+        success = EXIT_FAILURE;
+        std::cout << "Column out of range did not throw" << std::endl;
+    }
+    catch (std::out_of_range &)
+    {
+    }
+    try
+    {
+        vecmat::block<2, 2>(m, 3, 0);
+        success = EXIT_FAILURE;
+        std::cout << "Block out of range did not throw" << std::endl;
+    }
+    catch (std::out_of_range &)
+    {
+    }
+
+    return success;
+}
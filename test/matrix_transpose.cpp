@@ -0,0 +1,150 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/matrix.hpp"
+#include "vecmat/transpose.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+/** Form the transpose the slow way for comparison
+ */
+template <size_t N, size_t M, typename T>
+vecmat::matrix<M, N, T> reference(const vecmat::matrix<N, M, T> & a)
+{
+    vecmat::matrix<M, N, T> b;
+    for (size_t i = 0; i < N; ++i)
+        for (size_t j = 0; j < M; ++j)
+            b(j, i) = a(i, j);
+    return b;
+}
+
+template <size_t N, size_t M, size_t K>
+int test_products(void)
+{
+    int success = EXIT_SUCCESS;
+
+    // Small integers keep every sum exact
+    vecmat::matrix<K, N, double> a;
+    vecmat::matrix<K, M, double> b;
+    vecmat::matrix<N, K, double> c;
+    for (size_t k = 0; k < K * N; ++k)
+        a[k] = static_cast<double>(k % 5) - 2.0;
+    for (size_t k = 0; k < K * M; ++k)
+        b[k] = static_cast<double>(k % 7) - 3.0;
+    for (size_t k = 0; k < N * K; ++k)
+        c[k] = static_cast<double>(k % 3) - 1.0;
+
+    const vecmat::matrix<N, K, double> at = reference(a);
+    const vecmat::matrix<M, K, double> bt = reference(b);
+
+    if (vecmat::dot(vecmat::transpose(a), b) != vecmat::dot(at, b))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "A^T B failed for " << N << "x" << M << "x" << K
+                  << std::endl;
+    }
+    if (vecmat::dot(c, vecmat::transpose(bt)) != vecmat::dot(c, b))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "A B^T failed for " << N << "x" << M << "x" << K
+                  << std::endl;
+    }
+    if (vecmat::dot(vecmat::transpose(a), vecmat::transpose(bt)) !=
+        vecmat::dot(at, b))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "A^T B^T failed for " << N << "x" << M << "x" << K
+                  << std::endl;
+    }
+
+    vecmat::vector<K, double> x;
+    vecmat::vector<N, double> y;
+    for (size_t k = 0; k < K; ++k)
+        x[k] = static_cast<double>(k % 4);
+    for (size_t k = 0; k < N; ++k)
+        y[k] = static_cast<double>(k % 3);
+    if (vecmat::dot(vecmat::transpose(a), x) != vecmat::dot(at, x) ||
+        vecmat::dot(y, vecmat::transpose(a)) != vecmat::dot(y, at))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Transposed matrix vector product failed for " << N
+                  << "x" << K << std::endl;
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::matrix<2, 3, float> a = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+    vecmat::matrix_transpose<3, 2, float> t = vecmat::transpose(a);
+    if (t(0, 1) != 2.0f || t(2, 0) != 5.0f || t[1] != 3.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Transposed element access failed" << std::endl;
+    }
+    if (vecmat::matrix<3, 2, float>(t) != reference(a))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Conversion failed:\n" << t << std::endl;
+    }
+    if (vecmat::transpose(t).ptr != a.data ||
+        vecmat::matrix<2, 3, float>(vecmat::transpose(t)) != a)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Double transpose failed" << std::endl;
+    }
+
+    // The view writes through to the original
+    t(2, 1) = 60.0f;
+    if (a(1, 2) != 60.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Transpose did not write through" << std::endl;
+    }
+    if (2.0f * t != t + t || t - t != vecmat::matrix<3, 2, float>())
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Transposed arithmetic failed" << std::endl;
+    }
+
+    // Small products take the unpacked path, large ones the blocked path
+    if (test_products<3, 4, 5>() != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (test_products<4, 4, 4>() != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (test_products<37, 45, 53>() != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    return success;
+}
@@ -0,0 +1,140 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/transpose.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+template <size_t N, size_t M, typename T>
+int test_fixed(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::matrix<N, M, T> a;
+    for (size_t k = 0; k < N * M; ++k)
+        a[k] = static_cast<T>(k);
+
+    vecmat::matrix<M, N, T> b = vecmat::transpose_copy(a);
+    for (size_t i = 0; i < N; ++i)
+        for (size_t j = 0; j < M; ++j)
+            if (b(j, i) != a(i, j))
+            {
+                success = EXIT_FAILURE;
+                std::cout << "Transpose of " << N << "x" << M
+                          << " failed at " << i << ", " << j << std::endl;
+                return success;
+            }
+    return success;
+}
+
+template <size_t N, typename T>
+int test_square(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::matrix<N, N, T> a;
+    for (size_t k = 0; k < N * N; ++k)
+        a[k] = static_cast<T>(k);
+    const vecmat::matrix<N, N, T> b = vecmat::transpose_copy(a);
+    if (vecmat::transpose_inplace(a) != b)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "In place transpose of " << N << "x" << N
+                  << " failed" << std::endl;
+    }
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    // Shapes on both sides of the leaf size and the 4x4 kernel
+    if (test_fixed<1, 1, float>() != EXIT_SUCCESS ||
+        test_fixed<4, 4, float>() != EXIT_SUCCESS ||
+        test_fixed<3, 7, float>() != EXIT_SUCCESS ||
+        test_fixed<33, 18, float>() != EXIT_SUCCESS ||
+        test_fixed<4, 4, double>() != EXIT_SUCCESS ||
+        test_fixed<45, 67, double>() != EXIT_SUCCESS ||
+        test_fixed<20, 13, int>() != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    if (test_square<1, float>() != EXIT_SUCCESS ||
+        test_square<4, double>() != EXIT_SUCCESS ||
+        test_square<17, float>() != EXIT_SUCCESS ||
+        test_square<50, double>() != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    // Runtime sizes well past the cache
+    const size_t n = 517;
+    const size_t m = 1031;
+    vecmat::dmatrix<float> a(n, m);
+    for (size_t k = 0; k < n * m; ++k)
+        a.data()[k] = static_cast<float>(k);
+    vecmat::dmatrix<float> b = vecmat::transpose_copy(a);
+    if (b.rows() != m || b.cols() != n)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Transposed size was " << b.rows() << "x" << b.cols()
+                  << std::endl;
+    }
+    else
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < m; ++j)
+                if (b(j, i) != a(i, j))
+                {
+                    success = EXIT_FAILURE;
+                    std::cout << "Runtime transpose failed at " << i
+                              << ", " << j << std::endl;
+                    i = n;
+                    break;
+                }
+
+    vecmat::dmatrix<float> c = a;
+    if (vecmat::transpose_inplace(c) != b)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Rectangular in place transpose failed" << std::endl;
+    }
+
+    vecmat::dmatrix<double> d(300, 300);
+    for (size_t k = 0; k < d.size(); ++k)
+        d.data()[k] = static_cast<double>(k);
+    vecmat::dmatrix<double> e = vecmat::transpose_copy(d);
+    if (vecmat::transpose_inplace(d) != e)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Square in place transpose failed" << std::endl;
+    }
+
+    return success;
+}
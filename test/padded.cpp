@@ -0,0 +1,180 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/padded.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+/** The alignment policy keeps the sizes of the fixed types */
+static_assert(vecmat::detail::storage_alignment<float, 16, 64>::value == 64,
+              "mat4<float> fills a cache line");
+static_assert(vecmat::detail::storage_alignment<float, 4, 64>::value == 16,
+              "vec4<float> fills a register");
+static_assert(vecmat::detail::storage_alignment<float, 3, 64>::value == 4,
+              "vec3<float> stays packed");
+static_assert(vecmat::detail::storage_alignment<double, 6, 64>::value == 16,
+              "6 doubles align to 16");
+static_assert(vecmat::detail::storage_alignment<float, 16, 0>::value ==
+                  alignof(float),
+              "no alignment by default");
+static_assert(sizeof(vecmat::vec3<float>) == 3 * sizeof(float) &&
+                  sizeof(vecmat::mat3<double>) == 9 * sizeof(double),
+              "the fixed types stay tightly packed");
+
+static_assert(sizeof(vecmat::padded_vec3<float>) == 16 &&
+                  alignof(vecmat::padded_vec3<float>) == 16,
+              "padded vec3 is one register");
+static_assert(sizeof(vecmat::padded_mat3<double>) == 96 &&
+                  alignof(vecmat::padded_mat3<double>) == 32,
+              "padded mat3 is three registers");
+
+template <size_t N, size_t M, typename T>
+bool zero_padding(const vecmat::padded_matrix<N, M, T> & a)
+{
+    for (size_t j = 0; j < M; ++j)
+        for (size_t i = N; i < a.padded; ++i)
+            if (a.data[i + j * a.padded] != 0)
+                return false;
+    return true;
+}
+
+template <size_t N, typename T>
+bool zero_padding(const vecmat::padded_vector<N, T> & a)
+{
+    for (size_t i = N; i < a.padded; ++i)
+        if (a.data[i] != 0)
+            return false;
+    return true;
+}
+
+/** Check the padded operations against the packed ones.  Small
+ * integers keep the results exact.
+ */
+template <size_t N, size_t M, typename T>
+int test_size(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::matrix<N, M, T> a {};
+    vecmat::matrix<M, 2, T> b {};
+    vecmat::vector<M, T> x {};
+    vecmat::vector<M, T> y {};
+    for (size_t k = 0; k < N * M; ++k)
+        a[k] = static_cast<T>(k % 7 + 1);
+    for (size_t k = 0; k < 2 * M; ++k)
+        b[k] = static_cast<T>(k % 3 + 1);
+    for (size_t k = 0; k < M; ++k)
+    {
+        x[k] = static_cast<T>(k + 1);
+        y[k] = static_cast<T>(2 * k + 1);
+    }
+
+    const vecmat::padded_matrix<N, M, T> pa = vecmat::pad(a);
+    const vecmat::padded_matrix<M, 2, T> pb = vecmat::pad(b);
+    const vecmat::padded_vector<M, T> px = vecmat::pad(x);
+    const vecmat::padded_vector<M, T> py = vecmat::pad(y);
+
+    if (static_cast<vecmat::matrix<N, M, T> >(pa) != a ||
+        static_cast<vecmat::vector<M, T> >(px) != x ||
+        pa(N - 1, M - 1) != a(N - 1, M - 1) || px[M - 1] != x[M - 1])
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Padding round trip failed for " << N << "x" << M
+                  << std::endl;
+    }
+
+    const vecmat::padded_vector<M, T> pv = (px + py) * py / px - 1 + 2 * -px;
+    const vecmat::vector<M, T> v = (x + y) * y / x - 1 + 2 * -x;
+    const vecmat::padded_matrix<N, M, T> pm = (pa / pa + pa) * 2 - 1;
+    const vecmat::matrix<N, M, T> m = (a / a + a) * 2 - 1;
+    if (static_cast<vecmat::vector<M, T> >(pv) != v || !zero_padding(pv) ||
+        static_cast<vecmat::matrix<N, M, T> >(pm) != m || !zero_padding(pm))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Element-wise operations failed for " << N << "x" << M
+                  << ": " << pv << " and " << v << std::endl;
+    }
+
+    const vecmat::padded_vector<N, T> pax = vecmat::dot(pa, px);
+    const vecmat::padded_matrix<N, 2, T> pab = vecmat::dot(pa, pb);
+    if (vecmat::dot(px, py) != vecmat::dot(x, y) ||
+        static_cast<vecmat::vector<N, T> >(pax) != vecmat::dot(a, x) ||
+        static_cast<vecmat::matrix<N, 2, T> >(pab) != vecmat::dot(a, b) ||
+        !zero_padding(pax) || !zero_padding(pab))
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Products failed for " << N << "x" << M << std::endl;
+    }
+
+    // Default initialization leaves the padding indeterminate; NaN
+    // stands in for whatever it holds
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    vecmat::padded_matrix<N, M, T> da;
+    vecmat::padded_vector<M, T> dx;
+    std::fill(da.data, da.data + da.padded * M, nan);
+    std::fill(dx.data, dx.data + dx.padded, nan);
+    for (size_t j = 0; j < M; ++j)
+    {
+        dx[j] = x[j];
+        for (size_t i = 0; i < N; ++i)
+            da(i, j) = a(i, j);
+    }
+
+    const vecmat::padded_vector<N, T> dax = vecmat::dot(da, dx);
+    const vecmat::padded_matrix<N, 2, T> dab = vecmat::dot(da, pb);
+    if (vecmat::dot(dx, py) != vecmat::dot(x, y) ||
+        vecmat::dot(dx, dx) != vecmat::dot(x, x) ||
+        static_cast<vecmat::vector<N, T> >(dax) != vecmat::dot(a, x) ||
+        static_cast<vecmat::matrix<N, 2, T> >(dab) != vecmat::dot(a, b) ||
+        !zero_padding(dax) || !zero_padding(dab) || dx + py != px + py)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Default initialized products failed for " << N
+                  << "x" << M << std::endl;
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    if (test_size<3, 3, float>() != EXIT_SUCCESS ||
+        test_size<3, 3, double>() != EXIT_SUCCESS ||
+        test_size<4, 4, float>() != EXIT_SUCCESS ||
+        test_size<3, 5, double>() != EXIT_SUCCESS ||
+        test_size<5, 2, float>() != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    return success;
+}
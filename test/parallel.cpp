@@ -0,0 +1,145 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/parallel.hpp"
+#include "vecmat/thread_pool.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+/** Check the split element-wise operations element by element
+ *
+ * The lengths are past the threshold and not a whole number of cache
+ * lines, so the last thread gets a ragged range.  Small integers keep
+ * every result exact.
+ */
+template <typename T>
+int test_vector(size_t n)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::dvector<T> a(n), b(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = static_cast<T>(i % 7 + 1);
+        b[i] = static_cast<T>(i % 5 + 1);
+    }
+
+    vecmat::dvector<T> c = (a + b) * b - a;
+    c /= b;
+    c += static_cast<T>(2);
+    c = -std::move(c);
+    vecmat::dvector<float> f = vecmat::resize_cast<float>(a, n + 3);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const T x = static_cast<T>(i % 7 + 1);
+        const T y = static_cast<T>(i % 5 + 1);
+        if (c[i] != -(((x + y) * y - x) / y + 2) ||
+            f[i] != static_cast<float>(x))
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Element " << i << " of " << n << " is " << c[i]
+                      << " and " << f[i] << std::endl;
+            break;
+        }
+    }
+    if (f[n] != 0 || f[n + 2] != 0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "The cast did not zero the tail" << std::endl;
+    }
+
+    a = static_cast<T>(3);
+    for (size_t i = 0; i < n; ++i)
+        if (a[i] != 3)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "The fill missed element " << i << std::endl;
+            break;
+        }
+
+    return success;
+}
+
+/** Both the contiguous and the column split casts of a matrix
+ */
+int test_matrix(size_t n, size_t m)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::dmatrix<double> a(n, m);
+    for (size_t k = 0; k < n * m; ++k)
+        a.data()[k] = static_cast<double>(k % 11);
+    a *= 2;
+
+    const vecmat::dmatrix<float> same = vecmat::resize_cast<float>(a, n, m);
+    const vecmat::dmatrix<float> more =
+        vecmat::resize_cast<float>(a, n + 1, m - 1);
+    for (size_t j = 0; j < m; ++j)
+        for (size_t i = 0; i < n; ++i)
+        {
+            const float x = static_cast<float>((i + j * n) % 11 * 2);
+            if (same(i, j) != x ||
+                (j < m - 1 && (more(i, j) != x || more(n, j) != 0)))
+            {
+                success = EXIT_FAILURE;
+                std::cout << "Matrix cast failed at " << i << ", " << j
+                          << std::endl;
+                return success;
+            }
+        }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    const size_t n = vecmat::detail::parallel_threshold + 1001;
+    const size_t threads[] = {1, 3, 8};
+    for (size_t t : threads)
+    {
+        vecmat::set_num_threads(t);
+        if (test_vector<float>(n) != EXIT_SUCCESS ||
+            test_vector<double>(3 * n) != EXIT_SUCCESS ||
+            test_vector<int32_t>(n) != EXIT_SUCCESS ||
+            test_matrix(1001, n / 1000) != EXIT_SUCCESS)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "with " << t << " threads" << std::endl;
+        }
+    }
+
+    return success;
+}
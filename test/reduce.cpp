@@ -0,0 +1,239 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/batch.hpp"
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/reduce.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+template <typename T>
+bool close(T a, T b)
+{
+    const T tol = sizeof(T) == 4 ? T(1.0e-5) : T(1.0e-12);
+    return std::fabs(a - b) <= tol * (1 + std::fabs(b));
+}
+
+/** Compare the reductions of `a`, holding `n` elements, with plain
+ * loops.  Small integers keep the sums exact.
+ */
+template <typename V, typename T>
+int test_reductions(const char * name, const V & a, size_t n, T)
+{
+    int success = EXIT_SUCCESS;
+
+    T s = 0, q = 0, lo = a[0], hi = a[0];
+    size_t ilo = 0, ihi = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        s += a[i];
+        q += a[i] * a[i];
+        if (a[i] < lo)
+        {
+            lo = a[i];
+            ilo = i;
+        }
+        if (a[i] > hi)
+        {
+            hi = a[i];
+            ihi = i;
+        }
+    }
+    if (sum(a) != s || min(a) != lo || max(a) != hi ||
+        argmin(a) != ilo || argmax(a) != ihi)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " of " << n << ": sum " << sum(a) << " != "
+                  << s << ", min " << min(a) << " != " << lo << " at "
+                  << argmin(a) << " != " << ilo << ", max " << max(a)
+                  << " != " << hi << " at " << argmax(a) << " != " << ihi
+                  << std::endl;
+    }
+    if (norm(a) != std::sqrt(q) || ! close(norm(normalize(a)), T(1)))
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " of " << n << ": norm " << norm(a)
+                  << " != " << std::sqrt(q) << std::endl;
+    }
+
+    return success;
+}
+
+template <typename V>
+void fill(V & a, size_t n, size_t shift)
+{
+    for (size_t i = 0; i < n; ++i)
+        a[i] = static_cast<int>((i * 7 + shift) % 23) - 11;
+}
+
+template <typename T>
+int test_types(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::vector<3, T> a;
+    vecmat::vector<67, T> b;
+    vecmat::matrix<9, 5, T> c;
+    fill(a, 3, 1);
+    fill(b, 67, 5);
+    fill(c, 45, 2);
+    if (test_reductions("vector", a, 3, T()) != EXIT_SUCCESS ||
+        test_reductions("vector", b, 67, T()) != EXIT_SUCCESS ||
+        test_reductions("matrix", c, 45, T()) != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    const size_t sizes[] = {1, 15, 16, 17, 64, 1000, 1023};
+    for (size_t n: sizes)
+    {
+        vecmat::dvector<T> d(n);
+        fill(d, n, n);
+        vecmat::dmatrix<T> e(n, 3);
+        fill(e, 3 * n, n + 1);
+        if (test_reductions("dvector", d, n, T()) != EXIT_SUCCESS ||
+            test_reductions("dmatrix", e, 3 * n, T()) != EXIT_SUCCESS)
+            success = EXIT_FAILURE;
+
+        const vecmat::dvector<T> g = column_norms(e);
+        for (size_t j = 0; j < 3; ++j)
+        {
+            T q = 0;
+            for (size_t i = 0; i < n; ++i)
+                q += e(i, j) * e(i, j);
+            if (g[j] != std::sqrt(q))
+            {
+                success = EXIT_FAILURE;
+                std::cout << "Column norm " << j << " of " << n
+                          << " rows failed" << std::endl;
+            }
+        }
+    }
+
+    const vecmat::vector<5, T> f = column_norms(c);
+    for (size_t j = 0; j < 5; ++j)
+    {
+        vecmat::vector<9, T> column;
+        for (size_t i = 0; i < 9; ++i)
+            column[i] = c(i, j);
+        if (f[j] != vecmat::norm(column))
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Fixed column norm " << j << " failed"
+                      << std::endl;
+        }
+    }
+
+    // Batched normalization of both layouts
+    const size_t count = 1001;
+    std::vector<vecmat::vector<3, T> > p(count);
+    for (size_t i = 0; i < count; ++i)
+        p[i] = {static_cast<T>(i % 7) + 1, static_cast<T>(i % 5) - 2,
+                static_cast<T>(i % 3)};
+    vecmat::vector_batch<3, T> soa = vecmat::to_soa(p.data(), count);
+    std::vector<vecmat::vector<3, T> > q = p;
+    vecmat::normalize(q.data(), count);
+    vecmat::normalize(soa);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const vecmat::vector<3, T> e = normalize(p[i]);
+        const vecmat::vector<3, T> r = soa[i];
+        for (size_t j = 0; j < 3; ++j)
+            if (! close(q[i][j], e[j]) || ! close(r[j], e[j]))
+            {
+                success = EXIT_FAILURE;
+                std::cout << "Batched normalize failed at " << i << ": "
+                          << q[i] << " != " << e << std::endl;
+                i = count;
+                break;
+            }
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    if (test_types<float>() != EXIT_SUCCESS ||
+        test_types<double>() != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    // The integer extremes use the integer packs
+    vecmat::dvector<int32_t> k(100);
+    fill(k, 100, 3);
+    k[57] = 40;
+    k[91] = -40;
+    int32_t total = 0;
+    for (size_t i = 0; i < k.size(); ++i)
+        total += k[i];
+    if (vecmat::max(k) != 40 || vecmat::argmax(k) != 57 ||
+        vecmat::min(k) != -40 || vecmat::argmin(k) != 91 ||
+        vecmat::sum(k) != total)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "The integer reductions failed" << std::endl;
+    }
+
+    // A NaN gives its own index rather than one past the end
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const vecmat::dvector<float> n1 = {2.0f, 1.0f, nan};
+    const vecmat::dvector<float> n2 = {1.0f, nan, 2.0f, nan};
+    const vecmat::vector<3, double> n3 = {
+        {std::numeric_limits<double>::quiet_NaN(), -1.0, 1.0}};
+    if (vecmat::argmin(n1) != 2 || vecmat::argmax(n1) != 2 ||
+        vecmat::argmin(n2) != 1 || vecmat::argmax(n2) != 1 ||
+        vecmat::argmin(n3) != 0 || vecmat::argmax(n3) != 0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "The arg functions mishandled NaN: "
+                  << vecmat::argmin(n1) << " " << vecmat::argmax(n1) << " "
+                  << vecmat::argmin(n2) << " " << vecmat::argmax(n2)
+                  << std::endl;
+    }
+
+    try
+    {
+        vecmat::max(vecmat::dvector<float>());
+        success = EXIT_FAILURE;
+        std::cout << "The maximum of nothing succeeded" << std::endl;
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    return success;
+}
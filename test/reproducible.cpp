@@ -0,0 +1,133 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/accumulate.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/thread_pool.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+/** Compare the bits, so signed zeros and NaNs count
+ */
+template <typename T>
+bool same_bits(T a, T b)
+{
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+/** The reproducible sums of numbers that are not exact in binary
+ *
+ * The pool runs with several thread counts and the chunks are added
+ * with the scalar lanes as well as the widest packs the build has.
+ * Every one must give the same bits.
+ */
+template <typename T>
+int test_type(const char * name)
+{
+    int success = EXIT_SUCCESS;
+
+    const size_t n = 1000003;
+    vecmat::dvector<T> a(n), b(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = static_cast<T>(1) / static_cast<T>(i % 977 + 3);
+        b[i] = static_cast<T>(i % 13) / static_cast<T>(7) - 1;
+    }
+
+    const vecmat::reproducible_sum mode;
+    vecmat::set_num_threads(1);
+    const T d = vecmat::dot(a, b, mode);
+    const T s = vecmat::sum(a, mode);
+    const T r = vecmat::norm(b, mode);
+
+    const T * x = a.data();
+    const T * y = b.data();
+    typedef vecmat::simd::scalar<T> S;
+    const T ds = vecmat::detail::reproducible_chunks<T>(n,
+        [=](size_t i0, size_t i1) {
+            return vecmat::detail::reproducible_block<S>(x + i0, y + i0,
+                                                         i1 - i0);
+        });
+    const T ss = vecmat::detail::reproducible_chunks<T>(n,
+        [=](size_t i0, size_t i1) {
+            return vecmat::detail::reproducible_block<S>(x + i0, i1 - i0);
+        });
+    if (!same_bits(d, ds) || !same_bits(s, ss))
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " packs and scalars disagree: " << d << " "
+                  << ds << ", " << s << " " << ss << std::endl;
+    }
+
+    for (size_t t = 2; t <= 8; t += 3)
+    {
+        vecmat::set_num_threads(t);
+        if (!same_bits(vecmat::dot(a, b, mode), d) ||
+            !same_bits(vecmat::sum(a, mode), s) ||
+            !same_bits(vecmat::norm(b, mode), r))
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " changed with " << t << " threads"
+                      << std::endl;
+        }
+    }
+    vecmat::set_num_threads(1);
+
+    // Exact sums agree with the fast path
+    vecmat::vector<37, T> u, v;
+    for (size_t i = 0; i < 37; ++i)
+    {
+        u[i] = static_cast<T>(static_cast<int>(i % 9) - 4);
+        v[i] = static_cast<T>(static_cast<int>(i % 4) - 1);
+    }
+    if (vecmat::dot(u, v, mode) != vecmat::dot(u, v) ||
+        vecmat::sum(u, mode) != vecmat::sum(u) ||
+        vecmat::sum(vecmat::dvector<T>(), mode) != 0)
+    {
+        success = EXIT_FAILURE;
+        std::cout << name << " disagrees with the fast path" << std::endl;
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    if (test_type<float>("float") != EXIT_SUCCESS ||
+        test_type<double>("double") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    return success;
+}
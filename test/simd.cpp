@@ -0,0 +1,130 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/matrix.hpp"
+#include "vecmat/simd.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// Long enough to exercise the packed body and the scalar tail of every
+// register width
+static const size_t N = 37;
+
+template <typename T>
+int check(const char * name)
+{
+    int success = EXIT_SUCCESS;
+    vecmat::vector<N, T> a {};
+    vecmat::vector<N, T> b {};
+    for (size_t i = 0; i < N; ++i)
+    {
+        a[i] = static_cast<T>(2 * (i + 1));
+        b[i] = static_cast<T>(i + 1);
+    }
+
+    vecmat::vector<N, T> c = a;
+    c += b;
+    for (size_t i = 0; i < N; ++i)
+        if (c[i] != static_cast<T>(3 * (i + 1)))
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " addition failed at " << i << std::endl;
+        }
+
+    c = a;
+    c -= b;
+    for (size_t i = 0; i < N; ++i)
+        if (c[i] != b[i])
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " subtraction failed at " << i
+                << std::endl;
+        }
+
+    c = a;
+    c *= b;
+    for (size_t i = 0; i < N; ++i)
+        if (c[i] != static_cast<T>(2 * (i + 1) * (i + 1)))
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " multiplication failed at " << i
+                << std::endl;
+        }
+
+    c = a;
+    c /= b;
+    for (size_t i = 0; i < N; ++i)
+        if (c[i] != static_cast<T>(2))
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " division failed at " << i << std::endl;
+        }
+
+    c = a;
+    c *= static_cast<T>(3);
+    c -= static_cast<T>(1);
+    for (size_t i = 0; i < N; ++i)
+        if (c[i] != static_cast<T>(6 * (i + 1) - 1))
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " scalar broadcast failed at " << i
+                << std::endl;
+        }
+
+    vecmat::matrix<N, 3, T> d {};
+    d += static_cast<T>(-5);
+    d *= static_cast<T>(-7);
+    for (auto x: d)
+        if (x != static_cast<T>(35))
+        {
+            success = EXIT_FAILURE;
+            std::cout << name << " matrix broadcast failed" << std::endl;
+            break;
+        }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+    if (check<float>("float") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check<double>("double") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check<int32_t>("int32_t") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+    if (check<long>("long") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    return success;
+}
@@ -0,0 +1,160 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/axpy.hpp"
+#include "vecmat/dmatrix.hpp"
+#include "vecmat/dvector.hpp"
+#include "vecmat/stream.hpp"
+#include "vecmat/thread_pool.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+/** The kernels with every alignment of the output and lengths around
+ * whole cache lines
+ */
+template <typename T, typename U>
+int test_kernels(const char * name)
+{
+    int success = EXIT_SUCCESS;
+
+    std::vector<U> in(300);
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = static_cast<U>(i % 23) - 11;
+    std::vector<T> out(in.size() + 16);
+
+    for (size_t offset = 0; offset < 16; ++offset)
+        for (size_t n = 0; n < in.size(); n += 7)
+        {
+            T * p = out.data() + offset;
+            vecmat::detail::stream_fill(p, static_cast<T>(5), n + 1);
+            for (size_t i = 0; i <= n; ++i)
+                if (p[i] != 5)
+                {
+                    success = EXIT_FAILURE;
+                    std::cout << name << " fill missed " << i << " of "
+                              << n + 1 << " at " << offset << std::endl;
+                    return success;
+                }
+            vecmat::detail::stream_cast(p, in.data(), n);
+            for (size_t i = 0; i < n; ++i)
+                if (p[i] != static_cast<T>(in[i]))
+                {
+                    success = EXIT_FAILURE;
+                    std::cout << name << " cast missed " << i << " of " << n
+                              << " at " << offset << std::endl;
+                    return success;
+                }
+            if (p[n] != 5)
+            {
+                success = EXIT_FAILURE;
+                std::cout << name << " cast wrote past " << n << std::endl;
+                return success;
+            }
+        }
+
+    return success;
+}
+
+/** The dynamic types past the streaming threshold, which the build of
+ * this test lowers
+ */
+template <typename T>
+int test_dynamic(size_t n)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::dvector<T> a(n, static_cast<T>(2));
+    vecmat::dvector<T> b(n);
+    for (size_t i = 0; i < n; ++i)
+        b[i] = static_cast<T>(i % 9);
+
+    vecmat::dvector<T> c(b);
+    vecmat::dvector<T> d(3);
+    d = b;
+    const vecmat::dvector<T> e = vecmat::fma(a, b, c);
+    const vecmat::dvector<double> f = vecmat::resize_cast<double>(b, n + 5);
+    a = static_cast<T>(7);
+    for (size_t i = 0; i < n; ++i)
+        if (a[i] != 7 || c[i] != b[i] || d[i] != b[i] ||
+            e[i] != 3 * b[i] || f[i] != static_cast<double>(b[i]))
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Vector element " << i << " of " << n
+                      << " is wrong" << std::endl;
+            return success;
+        }
+    if (f[n] != 0 || f[n + 4] != 0 || d.size() != n)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Vector sizes or tails are wrong" << std::endl;
+    }
+
+    vecmat::dmatrix<T> g(n / 10, 10, static_cast<T>(1));
+    g(3, 4) = 9;
+    vecmat::dmatrix<T> h(1, 1);
+    h = g;
+    const vecmat::dmatrix<T> k(g);
+    if (h != g || k != g || h.rows() != n / 10)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Matrix copies are wrong" << std::endl;
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    if (test_kernels<float, float>("float") != EXIT_SUCCESS ||
+        test_kernels<double, double>("double") != EXIT_SUCCESS ||
+        test_kernels<int32_t, int32_t>("int32") != EXIT_SUCCESS ||
+        test_kernels<float, double>("double to float") != EXIT_SUCCESS ||
+        test_kernels<double, int32_t>("int32 to double") != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    const size_t threads[] = {1, 4};
+    for (size_t t : threads)
+    {
+        vecmat::set_num_threads(t);
+        if (test_dynamic<float>(10007) != EXIT_SUCCESS ||
+            test_dynamic<double>(vecmat::detail::parallel_threshold + 13) !=
+                EXIT_SUCCESS)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "with " << t << " threads" << std::endl;
+        }
+    }
+
+    return success;
+}
@@ -0,0 +1,179 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/gemm.hpp"
+#include "vecmat/thread_pool.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::set_num_threads(4);
+    if (vecmat::num_threads() != 4)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Pool size was " << vecmat::num_threads()
+            << " and not 4" << std::endl;
+    }
+
+    // Every task runs exactly once
+    std::vector<std::atomic<int>> hits(1000);
+    for (auto & h: hits)
+        h = 0;
+    vecmat::parallel_for(hits.size(), [&](size_t i) { ++hits[i]; });
+    for (size_t i = 0; i < hits.size(); ++i)
+        if (hits[i] != 1)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Task " << i << " ran " << hits[i] << " times"
+                << std::endl;
+        }
+
+    // Nested jobs run inline instead of deadlocking
+    std::atomic<int> nested(0);
+    vecmat::parallel_for(8, [&](size_t) {
+        vecmat::parallel_for(8, [&](size_t) { ++nested; });
+    });
+    if (nested != 64)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Nested jobs ran " << nested << " tasks" << std::endl;
+    }
+
+    // Exceptions make it back to the caller
+    bool caught = false;
+    try
+    {
+        vecmat::parallel_for(100, [](size_t i) {
+            if (i == 37)
+                throw std::runtime_error("task failed");
+        });
+    }
+    catch (const std::runtime_error &)
+    {
+        caught = true;
+    }
+    if (!caught)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Task exception was lost" << std::endl;
+    }
+
+    // The parallel product matches the serial product
+    const size_t m = 301, n = 263, k = 157;
+    std::vector<double> a(m * k), b(k * n), c1(m * n), c4(m * n);
+    for (size_t i = 0; i < a.size(); ++i)
+        a[i] = static_cast<double>(i % 9) - 4.0;
+    for (size_t i = 0; i < b.size(); ++i)
+        b[i] = static_cast<double>(i % 7) - 3.0;
+
+    vecmat::gemm(m, n, k, a.data(), m, b.data(), k, c4.data(), m);
+    vecmat::set_num_threads(1);
+    vecmat::gemm(m, n, k, a.data(), m, b.data(), k, c1.data(), m);
+    if (c1 != c4)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Parallel product differs from serial" << std::endl;
+    }
+
+    vecmat::set_num_threads(3);
+    if (vecmat::num_threads() != 3)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Resize to 3 threads failed" << std::endl;
+    }
+
+    // Workers added after earlier jobs wait for the next one
+    for (size_t t = 1; t <= 8; ++t)
+    {
+        vecmat::set_num_threads(t);
+        std::atomic<int> count(0);
+        for (size_t r = 0; r < 20; ++r)
+            vecmat::parallel_for(64, [&](size_t) { ++count; });
+        if (count != 20 * 64)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Jobs after growing to " << t << " threads ran "
+                << count << " tasks" << std::endl;
+        }
+    }
+
+    // Resizing from inside a task throws instead of deadlocking
+    for (size_t t = 1; t <= 2; ++t)
+    {
+        vecmat::set_num_threads(t);
+        std::atomic<int> refused(0);
+        vecmat::parallel_for(4, [&](size_t) {
+            try
+            {
+                vecmat::set_num_threads(2);
+            }
+            catch (const std::logic_error &)
+            {
+                ++refused;
+            }
+        });
+        if (refused != 4)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Resize inside a task was allowed" << std::endl;
+        }
+    }
+
+    // The size can be read from any thread while another resizes
+    std::atomic<bool> resizing(true);
+    std::thread resizer([&] {
+        for (size_t r = 0; r < 50; ++r)
+            vecmat::set_num_threads(r % 4 + 1);
+        resizing = false;
+    });
+    size_t reads = 0;
+    while (resizing || reads == 0)
+    {
+        const size_t n = vecmat::num_threads();
+        if (n < 1 || n > 4)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Read " << n << " threads while resizing"
+                      << std::endl;
+            break;
+        }
+        ++reads;
+    }
+    resizer.join();
+
+    return success;
+}
@@ -0,0 +1,150 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/batch.hpp"
+#include "vecmat/matrix.hpp"
+#include "vecmat/thread_pool.hpp"
+#include "vecmat/transform.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+template <size_t N>
+bool close(const vecmat::vector<N, float> & a,
+           const vecmat::vector<N, float> & b)
+{
+    for (size_t i = 0; i < N; ++i)
+        if (std::fabs(a[i] - b[i]) > 1.0e-5f * (1.0f + std::fabs(b[i])))
+            return false;
+    return true;
+}
+
+int test_transform(size_t n)
+{
+    int success = EXIT_SUCCESS;
+
+    // A projection-like matrix with a w row so the divide does work
+    const vecmat::matrix<4, 4, float> m = {
+        2.0f, 0.0f, 1.0f,  1.0f,
+        0.0f, 3.0f, 0.0f, -1.0f,
+        1.0f, 0.0f, 1.0f,  2.0f,
+        4.0f, 5.0f, 6.0f, 20.0f};
+
+    // Small integers keep the products exact without the divide
+    std::vector<vecmat::vector<3, float> > p3(n);
+    std::vector<vecmat::vector<4, float> > p4(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float x = static_cast<float>(i % 11);
+        const float y = static_cast<float>(i % 7) - 3.0f;
+        const float z = static_cast<float>(i % 5);
+        p3[i] = {x, y, z};
+        p4[i] = {x, y, z, 1.0f};
+    }
+
+    std::vector<vecmat::vector<4, float> > q4(n);
+    std::vector<vecmat::vector<3, float> > q3(n);
+    vecmat::transform(m, p4.data(), q4.data(), n);
+    vecmat::transform(m, p3.data(), q3.data(), n);
+    vecmat::vector_batch<3, float> b3 =
+        vecmat::transform(m, vecmat::to_soa(p3.data(), n));
+    vecmat::vector_batch<4, float> b4 =
+        vecmat::transform(m, vecmat::to_soa(p4.data(), n));
+    for (size_t i = 0; i < n; ++i)
+    {
+        const vecmat::vector<4, float> e = vecmat::dot(m, p4[i]);
+        const vecmat::vector<3, float> e3 =
+            vecmat::resize_cast<3, float>(e);
+        if (q4[i] != e || q3[i] != e3 ||
+            vecmat::vector<3, float>(b3[i]) != e3 ||
+            vecmat::vector<4, float>(b4[i]) != e)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Transform of " << n << " points failed at " << i
+                      << ": " << q4[i] << " != " << e << std::endl;
+            break;
+        }
+    }
+
+    vecmat::transform(m, p4.data(), q4.data(), n, true);
+    vecmat::transform(m, p3.data(), q3.data(), n, true);
+    b3 = vecmat::transform(m, vecmat::to_soa(p3.data(), n), true);
+    b4 = vecmat::transform(m, vecmat::to_soa(p4.data(), n), true);
+    for (size_t i = 0; i < n; ++i)
+    {
+        vecmat::vector<4, float> e = vecmat::dot(m, p4[i]);
+        e /= e[3];
+        const vecmat::vector<3, float> e3 =
+            vecmat::resize_cast<3, float>(e);
+        if (!close(q4[i], e) || !close(q3[i], e3) ||
+            !close(vecmat::vector<3, float>(b3[i]), e3) ||
+            !close(vecmat::vector<4, float>(b4[i]), e))
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Perspective divide of " << n
+                      << " points failed at " << i << ": " << q4[i]
+                      << " != " << e << std::endl;
+            break;
+        }
+    }
+
+    // Transforming in place
+    b4 = vecmat::to_soa(p4.data(), n);
+    vecmat::vector_batch<4, float> c4 = vecmat::transform(m, b4);
+    vecmat::transform(m, b4, b4);
+    vecmat::transform(m, p4.data(), q4.data(), n);
+    vecmat::transform(m, p4.data(), p4.data(), n);
+    if (p4 != q4 || b4 != c4)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "In place transform failed" << std::endl;
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    if (test_transform(0) != EXIT_SUCCESS ||
+        test_transform(1) != EXIT_SUCCESS ||
+        test_transform(37) != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    // Large enough to split across the pool
+    vecmat::set_num_threads(3);
+    if (test_transform(50001) != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    return success;
+}
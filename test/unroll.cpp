@@ -0,0 +1,194 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/matrix.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+/** Compare the operations on an `N` by `M` matrix with plain loops
+ *
+ * Sizes up to the unroll limit take the unrolled path and larger ones
+ * the loops, so instantiating both sides of the limit checks that the
+ * two agree.  Small integers keep the sums exact.
+ */
+template <size_t N, size_t M, typename T>
+int test_size(void)
+{
+    int success = EXIT_SUCCESS;
+
+    vecmat::matrix<N, M, T> a;
+    vecmat::matrix<M, N, T> b;
+    vecmat::vector<M, T> x;
+    vecmat::vector<N, T> y;
+    for (size_t k = 0; k < N * M; ++k)
+    {
+        a[k] = static_cast<T>(k % 5 + 1);
+        b[k] = static_cast<T>(k % 3 + 1);
+    }
+    for (size_t k = 0; k < M; ++k)
+        x[k] = static_cast<T>(k + 1);
+    for (size_t k = 0; k < N; ++k)
+        y[k] = static_cast<T>(2 * k + 1);
+
+    vecmat::matrix<N, M, T> c = a;
+    c += a;
+    c *= static_cast<T>(3);
+    c -= a;
+    c /= static_cast<T>(5);
+    for (size_t k = 0; k < N * M; ++k)
+        if (c[k] != a[k])
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Compound assignment failed for " << N << "x" << M
+                      << std::endl;
+            break;
+        }
+
+    const vecmat::matrix<N, N, T> ab = vecmat::dot(a, b);
+    const vecmat::vector<N, T> ax = vecmat::dot(a, x);
+    const vecmat::vector<M, T> ya = vecmat::dot(y, a);
+    for (size_t i = 0; i < N; ++i)
+    {
+        T e = 0;
+        for (size_t k = 0; k < M; ++k)
+            e += a(i, k) * x[k];
+        if (ax[i] != e)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Matrix vector product failed for " << N << "x"
+                      << M << std::endl;
+            break;
+        }
+        for (size_t j = 0; j < N; ++j)
+        {
+            e = 0;
+            for (size_t k = 0; k < M; ++k)
+                e += a(i, k) * b(k, j);
+            if (ab(i, j) != e)
+            {
+                success = EXIT_FAILURE;
+                std::cout << "Matrix product failed for " << N << "x" << M
+                          << std::endl;
+                i = N;
+                break;
+            }
+        }
+    }
+    for (size_t j = 0; j < M; ++j)
+    {
+        T e = 0;
+        for (size_t k = 0; k < N; ++k)
+            e += y[k] * a(k, j);
+        if (ya[j] != e)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Vector matrix product failed for " << N << "x"
+                      << M << std::endl;
+            break;
+        }
+    }
+
+    T e = 0;
+    for (size_t k = 0; k < M; ++k)
+        e += x[k] * x[k];
+    if (vecmat::dot(x, x) != e)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Inner product failed for " << M << std::endl;
+    }
+
+    const vecmat::matrix<M + 1, N, double> r =
+        vecmat::resize_cast<M + 1, N, double>(a);
+    for (size_t j = 0; j < N; ++j)
+        for (size_t i = 0; i < M + 1; ++i)
+        {
+            const double want = i < N && j < M ? a(i, j) : 0;
+            if (r(i, j) != want)
+            {
+                success = EXIT_FAILURE;
+                std::cout << "Resize cast failed for " << N << "x" << M
+                          << std::endl;
+                i = M + 1;
+                j = N;
+            }
+        }
+
+    // Negation flips the sign of a zero like the scalar operator
+    vecmat::matrix<N, M, T> z = a;
+    z = static_cast<T>(0);
+    const vecmat::matrix<N, M, T> nz = -z;
+    for (size_t k = 0; k < N * M; ++k)
+        if (z[k] != 0 || std::signbit(nz[k]) != std::signbit(-z[k]))
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Fill or negation failed for " << N << "x" << M
+                      << std::endl;
+            break;
+        }
+
+    const vecmat::matrix<N, N, T> I = vecmat::eye<N, T>();
+    if (vecmat::dot(I, a) != a || -(-a) != a)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Identity failed for " << N << std::endl;
+    }
+
+    return success;
+}
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    if (test_size<1, 1, int>() != EXIT_SUCCESS ||
+        test_size<2, 3, float>() != EXIT_SUCCESS ||
+        test_size<3, 3, double>() != EXIT_SUCCESS ||
+        test_size<4, 4, float>() != EXIT_SUCCESS ||
+        test_size<8, 7, double>() != EXIT_SUCCESS ||
+        test_size<8, 8, int>() != EXIT_SUCCESS ||
+        test_size<9, 8, float>() != EXIT_SUCCESS ||
+        test_size<12, 9, double>() != EXIT_SUCCESS)
+        success = EXIT_FAILURE;
+
+    // A short operand of cross is padded with zero, never read past
+    vecmat::vector<2, float> a = {1.0f, 2.0f};
+    vecmat::vector<3, float> b = {3.0f, 4.0f, 5.0f};
+    vecmat::vector<3, float> ab = {10.0f, -5.0f, -2.0f};
+    if (vecmat::cross(a, b) != ab || vecmat::cross(b, a) != -ab)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Mixed size cross product failed: "
+                  << vecmat::cross(a, b) << std::endl;
+    }
+
+    return success;
+}
@@ -0,0 +1,168 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/batch.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    // An odd count leaves a partial pack at the end of every lane
+    const size_t n = 1001;
+    std::vector<vecmat::vector<3, float> > points(n);
+    std::vector<vecmat::vector<3, float> > normals(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float x = static_cast<float>(i % 17);
+        points[i] = {x, x + 1.0f, x - 2.0f};
+        normals[i] = {1.0f, static_cast<float>(i % 3), -1.0f};
+    }
+
+    vecmat::vector_batch<3, float> a = vecmat::to_soa(points.data(), n);
+    vecmat::vector_batch<3, float> b = vecmat::to_soa(normals.data(), n);
+    if (a.size() != n)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Size was " << a.size() << std::endl;
+    }
+    for (size_t k = 0; k < 3; ++k)
+        if (reinterpret_cast<uintptr_t>(a.lane(k)) % 64 != 0)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Lane " << k << " is not aligned" << std::endl;
+        }
+
+    std::vector<vecmat::vector<3, float> > round(n);
+    vecmat::to_aos(a, round.data());
+    if (round != points)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Round trip through the batch failed" << std::endl;
+    }
+
+    // Batched operators match the operators on each element
+    const vecmat::vector<3, float> offset = {1.0f, 2.0f, 4.0f};
+    vecmat::vector_batch<3, float> c = 2.0f * a - b + offset;
+    vecmat::dvector<float> d = vecmat::dot(a, b);
+    vecmat::vector_batch<3, float> e = vecmat::cross(a, b);
+    vecmat::vector_batch<4, double> f = vecmat::resize_cast<4, double>(a);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const vecmat::vector<3, float> & p = points[i];
+        const vecmat::vector<3, float> & q = normals[i];
+        if (vecmat::vector<3, float>(c[i]) != 2.0f * p - q + offset)
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Arithmetic failed at " << i << std::endl;
+            break;
+        }
+        if (d[i] != vecmat::dot(p, q))
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Dot product failed at " << i << std::endl;
+            break;
+        }
+        if (vecmat::vector<3, float>(e[i]) != vecmat::cross(p, q))
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Cross product failed at " << i << std::endl;
+            break;
+        }
+        if (vecmat::vector<4, double>(f[i]) !=
+            vecmat::resize_cast<4, double>(p))
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Resize cast failed at " << i << std::endl;
+            break;
+        }
+    }
+    if (d.size() != n)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Dot product size was " << d.size() << std::endl;
+    }
+
+    // Integer division leaves the zero padding of the divisor alone
+    vecmat::vector_batch<3, int> g(5, {{6, 8, 9}});
+    const vecmat::vector_batch<3, int> h(5, {{2, 4, 3}});
+    g /= h;
+    g /= g;
+    for (size_t i = 0; i < g.size(); ++i)
+        if (vecmat::vector<3, int>(g[i]) != vecmat::vector<3, int>{{1, 1, 1}})
+        {
+            success = EXIT_FAILURE;
+            std::cout << "Integer division failed at " << i << std::endl;
+            break;
+        }
+
+    // Elements are views that write through to the lanes
+    a[5] = offset;
+    a[6] *= 0.0f;
+    if (a.lane(2)[5] != 4.0f || a.lane(1)[6] != 0.0f ||
+        vecmat::vector<3, float>(a[4]) != points[4])
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Element access did not write through" << std::endl;
+    }
+
+    a.resize(10);
+    if (a.size() != 10 || vecmat::vector<3, float>(a[9]) != points[9])
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Resize lost the data" << std::endl;
+    }
+
+    try
+    {
+        a += b;
+        success = EXIT_FAILURE;
+        std::cout << "Mismatched sizes did not throw" << std::endl;
+    }
+    catch (std::out_of_range &)
+    {
+    }
+    try
+    {
+        a[10];
+        success = EXIT_FAILURE;
+        std::cout << "Access past the end did not throw" << std::endl;
+    }
+    catch (std::out_of_range &)
+    {
+    }
+
+    return success;
+}
@@ -0,0 +1,145 @@
+/*
+Copyright 2019 Keith F. Prussing
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vecmat/map.hpp"
+#include "vecmat/vector.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+int main(void)
+{
+    int success = EXIT_SUCCESS;
+
+    // An interleaved buffer like a vertex array: position then weight
+    float buffer[] = {1.0f, 2.0f, 3.0f, 10.0f,
+                      4.0f, 5.0f, 6.0f, 20.0f};
+
+    vecmat::vector_ref<3, float> p = vecmat::map<3>(buffer);
+    vecmat::vector_ref<3, float> q = vecmat::map<3>(buffer + 4);
+    vecmat::vector_ref<2, const float> w(buffer + 3, 4);
+
+    if (p[2] != 3.0f || q(1) != 5.0f || w[1] != 20.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Element access did not read through" << std::endl;
+    }
+
+    // In place arithmetic writes to the buffer
+    p += q;
+    if (buffer[0] != 5.0f || buffer[1] != 7.0f || buffer[2] != 9.0f ||
+        buffer[3] != 10.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Compound assignment did not write through"
+                  << std::endl;
+    }
+    p -= q;
+    p *= 2.0f;
+    if (buffer[0] != 2.0f || buffer[2] != 6.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Scalar compound assignment failed" << std::endl;
+    }
+
+    // Strided views take the scalar path
+    vecmat::vector_ref<2, float> s(buffer + 3, 4);
+    s /= 10.0f;
+    if (buffer[3] != 1.0f || buffer[7] != 2.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Strided compound assignment failed" << std::endl;
+    }
+
+    // Mixing views and vectors returns a vector
+    vecmat::vector<3, float> a = {1.0f, 1.0f, 1.0f};
+    vecmat::vector<3, float> b = q + a;
+    vecmat::vector<3, float> expect = {5.0f, 6.0f, 7.0f};
+    if (b != expect || (a + q) != expect)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Mixed addition failed: " << b << std::endl;
+    }
+    if (2.0f * q != q * 2.0f || (q - q) != vecmat::vector<3, float>())
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Scalar operators failed" << std::endl;
+    }
+
+    vecmat::vector<2, float> ones = {1.0f, 1.0f};
+    if (vecmat::dot(q, a) != 15.0f || vecmat::dot(ones, w) != 3.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Dot product failed" << std::endl;
+    }
+
+    vecmat::vector<3, float> x = {1.0f, 0.0f, 0.0f};
+    vecmat::vector<3, float> y = {0.0f, 1.0f, 0.0f};
+    vecmat::vector<3, float> z = {0.0f, 0.0f, 1.0f};
+    if (vecmat::cross(vecmat::vector_ref<3, float>(x), y) != z)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Cross product failed" << std::endl;
+    }
+
+    // Assignment copies the elements, not the view
+    vecmat::vector_ref<3, float> r(x);
+    r = y;
+    if (x != y || r.ptr != x.data)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Assignment did not copy elements" << std::endl;
+    }
+    r = 3.0f;
+    if (x[0] != 3.0f || x[1] != 3.0f || x[2] != 3.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Scalar assignment failed" << std::endl;
+    }
+
+    // Streams follow the owning vector
+    std::stringstream ss;
+    ss << q;
+    if (ss.str() != "4, 5, 6")
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Output was '" << ss.str() << "'" << std::endl;
+    }
+    ss.str("7, 8, 9");
+    ss.clear();
+    ss >> q;
+    if (buffer[4] != 7.0f || buffer[6] != 9.0f)
+    {
+        success = EXIT_FAILURE;
+        std::cout << "Input did not write through" << std::endl;
+    }
+
+    return success;
+}